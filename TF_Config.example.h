@@ -17,10 +17,10 @@
 // If the connection is reliable, you can disable the SOF byte and checksums.
 // That can save up to 9 bytes of overhead.
 
-// ,-----+-----+-----+------+------------+- - - -+-------------,                
-// | SOF | ID  | LEN | TYPE | HEAD_CKSUM | DATA  | DATA_CKSUM  |                
-// | 0-1 | 1-4 | 1-4 | 1-4  | 0-4        | ...   | 0-4         | <- size (bytes)
-// '-----+-----+-----+------+------------+- - - -+-------------'                
+// ,-----+------+-----+-----+------+------------+- - - -+-------------,
+// | SOF | ADDR | ID  | LEN | TYPE | HEAD_CKSUM | DATA  | DATA_CKSUM  |
+// | 0-1 | 0-4  | 1-4 | 1-4 | 1-4  | 0-4        | ...   | 0-4         | <- size (bytes)
+// '-----+------+-----+-----+------+------------+- - - -+-------------'
 
 // !!! BOTH PEERS MUST USE THE SAME SETTINGS !!!
 
@@ -29,11 +29,20 @@
 #define TF_LEN_BYTES    2
 #define TF_TYPE_BYTES   1
 
+// Destination address for multi-drop buses (0 = no address field, or 1, 2, 4).
+// Frames addressed to another node are skipped after the header (see TF_SetAddress()).
+#define TF_ADDR_BYTES   0
+// Address received by all nodes (default: all bits set)
+//#define TF_ADDR_BROADCAST 0xFF
+
 // Checksum type. Options:
 //   TF_CKSUM_NONE, TF_CKSUM_XOR, TF_CKSUM_CRC8, TF_CKSUM_CRC16, TF_CKSUM_CRC32
 //   TF_CKSUM_CUSTOM8, TF_CKSUM_CUSTOM16, TF_CKSUM_CUSTOM32
 // Custom checksums require you to implement checksum functions (see TinyFrame.h)
 #define TF_CKSUM_TYPE TF_CKSUM_CRC16
+// With a custom checksum, also implement TF_CksumAddBlock() to checksum the payload
+// and other contiguous spans at once (e.g. vectorized or in a hardware CRC unit)
+#define TF_USE_CKSUM_BLOCK 0
 
 // Use a SOF byte to mark the start of a frame
 #define TF_USE_SOF_BYTE 1
@@ -58,6 +67,7 @@ typedef uint8_t TF_COUNT;
 #define TF_SENDBUF_LEN    128
 
 // --- Listener counts - determine sizes of the static slot tables ---
+// (with TF_USE_DYNAMIC_LST, those are the sizes the tables can grow to)
 
 // Frame ID listeners (wait for response / multi-part message)
 #define TF_MAX_ID_LST   10
@@ -65,6 +75,8 @@ typedef uint8_t TF_COUNT;
 #define TF_MAX_TYPE_LST 10
 // Generic listeners (fallback if no other listener catches it)
 #define TF_MAX_GEN_LST  5
+// Type range / mask listeners (0 to disable, at most 32)
+#define TF_MAX_RANGE_LST 4
 
 // Timeout for receiving & parsing a frame
 // ticks = number of calls to TF_Tick()
@@ -73,6 +85,38 @@ typedef uint8_t TF_COUNT;
 // Whether to use mutex - requires you to implement TF_ClaimTx() and TF_ReleaseTx()
 #define TF_USE_MUTEX  1
 
+// Whether to support the streaming Rx mode (TF_SetStreamListener()), which lets a listener
+// handle the payload while it's being received, even if larger than TF_MAX_PAYLOAD_RX
+#define TF_USE_STREAM_RX 0
+
+// Whether to support filtering frames after the header (TF_SetRxFilter(), TF_SetTypeMaxLen()).
+// The payload of a rejected frame is skipped without buffering or checksumming it.
+#define TF_USE_RX_FILTER 0
+
+// Whether to support receiving the payload into a buffer chosen per frame (TF_SetRxDest()),
+// instead of tf->data
+#define TF_USE_RX_DEST 0
+
+// Whether the driver pulls the frames to send using TF_PollTx() (e.g. when a DMA transfer
+// completes), instead of the library pushing them to TF_WriteImpl(), which isn't used then
+#define TF_USE_PULL_TX 0
+
+// Size of the Rx ring buffer filled by TF_RxPush() (e.g. in an interrupt) and drained by
+// TF_Process() in the main loop. 0 to disable, otherwise a power of two.
+#define TF_RX_RING_LEN 0
+
+// Whether TF_Accept() parses the buffer with a faster engine, which stays in each parser state
+// for as long as the input lasts (e.g. copies the payload in one loop), instead of passing it
+// to TF_AcceptChar() byte by byte. Not used with TF_USE_STREAM_RX. If a whole frame is in the
+// buffer, the listeners get its payload in place (msg->data points into the TF_Accept() buffer).
+// Inputs shorter than TF_FAST_PARSER_MIN bytes (default 4) still go byte by byte.
+#define TF_USE_FAST_PARSER 0
+
+// Whether to allocate the listener tables on demand, instead of the static slot tables.
+// The tables grow when full and shrink in TF_Tick() when mostly unused. They're allocated
+// using realloc(), define TF_Realloc(ptr, size) and TF_Free(ptr) here to use a custom allocator.
+#define TF_USE_DYNAMIC_LST 0
+
 // Error reporting function. To disable debug, change to empty define
 #define TF_Error(format, ...) printf("[TF] " format "\n", ##__VA_ARGS__)
 
@@ -15,6 +15,56 @@
 #define TF_MIN(a, b) ((a)<(b)?(a):(b))
 #define TF_TRY(func) do { if(!(func)) return false; } while (0)
 
+// Memory barrier for data shared with an interrupt or another thread, can be replaced in the config file
+#ifndef TF_Barrier
+    #ifdef __GNUC__
+        #define TF_Barrier() __sync_synchronize()
+    #else
+        #define TF_Barrier()
+    #endif
+#endif
+
+// Position of the ID field in the header
+#if TF_ADDR_BYTES
+    #define TF_HEAD_ID_POS (TF_USE_SOF_BYTE + sizeof(TF_ADDR))
+#else
+    #define TF_HEAD_ID_POS (TF_USE_SOF_BYTE)
+#endif
+
+// Length of a checksum field
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+    #define TF_CKSUM_LEN sizeof(TF_CKSUM)
+#else
+    #define TF_CKSUM_LEN 0
+#endif
+
+// Header length (with the checksum)
+#define TF_HEAD_LEN (TF_HEAD_ID_POS + sizeof(TF_ID) + sizeof(TF_LEN) + sizeof(TF_TYPE) + TF_CKSUM_LEN)
+
+// Buffer the payload of the frame being received is stored in
+#if TF_USE_RX_DEST
+    #define TF_RX_BUF(tf) ((tf)->rx_dest)
+#else
+    #define TF_RX_BUF(tf) ((tf)->data)
+#endif
+
+// Payload of the frame being handled - the fast parser reads it in place if the whole frame is in the buffer
+#if TF_USE_FAST_PARSER && !TF_USE_STREAM_RX
+    #define TF_RX_PAYLOAD(tf) ((tf)->rx_inplace != NULL ? (tf)->rx_inplace : (const uint8_t *) TF_RX_BUF(tf))
+#else
+    #define TF_RX_PAYLOAD(tf) ((const uint8_t *) TF_RX_BUF(tf))
+#endif
+
+#if TF_USE_DYNAMIC_LST
+    // Allocator for the listener tables, can be replaced in the config file
+    #ifndef TF_Realloc
+        #define TF_Realloc(ptr, size) realloc(ptr, size)
+    #endif
+    #ifndef TF_Free
+        #define TF_Free(ptr) free(ptr)
+    #endif
+#endif
+
 
 // Type-dependent masks for bit manipulation in the ID field
 #define TF_ID_MASK (TF_ID)(((TF_ID)1 << (sizeof(TF_ID)*8 - 1)) - 1)
@@ -205,6 +255,20 @@
 #define CKSUM_ADD(cksum, byte) do { (cksum) = TF_CksumAdd((cksum), (byte)); } while (0)
 #define CKSUM_FINALIZE(cksum)  do { (cksum) = TF_CksumEnd((cksum)); } while (0)
 
+#if !(TF_USE_CKSUM_BLOCK && ((TF_CKSUM_TYPE == TF_CKSUM_CUSTOM8) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM16) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM32)))
+    /** Update a checksum with a block of bytes - byte by byte, unless a custom checksum implements it */
+    static inline TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len)
+    {
+        uint32_t i;
+        for (i = 0; i < len; i++) {
+            cksum = TF_CksumAdd(cksum, buf[i]);
+        }
+        return cksum;
+    }
+#endif
+
+#define CKSUM_ADD_BLOCK(cksum, buf, len) do { (cksum) = TF_CksumAddBlock((cksum), (buf), (len)); } while (0)
+
 //endregion
 
 
@@ -218,6 +282,13 @@ bool _TF_FN TF_InitStatic(TinyFrame *tf, TF_Peer peer_bit)
         return false;
     }
 
+#if TF_USE_DYNAMIC_LST
+    // Re-init - release the tables, they'd leak when zeroing the struct
+    if (tf->lst_owner == tf) {
+        TF_DeInitStatic(tf);
+    }
+#endif
+
     // Zero it out, keeping user config
     uint32_t usertag = tf->usertag;
     void * userdata = tf->userdata;
@@ -226,6 +297,9 @@ bool _TF_FN TF_InitStatic(TinyFrame *tf, TF_Peer peer_bit)
 
     tf->usertag = usertag;
     tf->userdata = userdata;
+#if TF_USE_DYNAMIC_LST
+    tf->lst_owner = tf;
+#endif
 
     tf->peer_bit = peer_bit;
     return true;
@@ -239,15 +313,34 @@ TinyFrame * _TF_FN TF_Init(TF_Peer peer_bit)
         TF_Error("TF_Init() failed, out of memory.");
         return NULL;
     }
+    memset(tf, 0, sizeof(TinyFrame)); // not an initialized instance
 
     TF_InitStatic(tf, peer_bit);
     return tf;
 }
 
+/** Release the listener tables, keeping the struct */
+void _TF_FN TF_DeInitStatic(TinyFrame *tf)
+{
+    if (tf == NULL) return;
+#if TF_USE_DYNAMIC_LST
+    TF_Free(tf->id_listeners);
+    TF_Free(tf->type_listeners);
+    TF_Free(tf->generic_listeners);
+    tf->id_listeners = NULL;
+    tf->type_listeners = NULL;
+    tf->generic_listeners = NULL;
+    tf->cap_id_lst = tf->cap_type_lst = tf->cap_generic_lst = 0;
+    tf->count_id_lst = tf->count_type_lst = tf->count_generic_lst = 0;
+    tf->lst_owner = NULL;
+#endif
+}
+
 /** Release the struct */
 void TF_DeInit(TinyFrame *tf)
 {
     if (tf == NULL) return;
+    TF_DeInitStatic(tf);
     free(tf);
 }
 
@@ -256,50 +349,265 @@ void TF_DeInit(TinyFrame *tf)
 
 //region Listeners
 
+#if TF_USE_DYNAMIC_LST
+
+/** Size of a listener table when it's first allocated */
+#define TF_LST_MIN_CAP 4
+
+#define TF_ID_LST_CAP(tf) ((tf)->cap_id_lst)
+#define TF_TYPE_LST_CAP(tf) ((tf)->cap_type_lst)
+#define TF_GEN_LST_CAP(tf) ((tf)->cap_generic_lst)
+
+/**
+ * Grow a full listener table (doubling it), zeroing the new slots.
+ * Returns the new table, or NULL if it can't grow (the old table is kept then).
+ */
+static void * _TF_FN lst_grow(void *table, TF_COUNT *cap, uint32_t max, size_t size)
+{
+    uint32_t newcap = (*cap == 0) ? TF_LST_MIN_CAP : (uint32_t) *cap * 2;
+    uint8_t *p;
+
+    if (newcap > max) newcap = max;
+    if (newcap <= *cap) return NULL;
+
+    p = TF_Realloc(table, newcap * size);
+    if (p == NULL) return NULL;
+
+    memset(p + *cap * size, 0, (newcap - *cap) * size);
+    *cap = (TF_COUNT) newcap;
+    return p;
+}
+
+/**
+ * Halve a listener table if at most a quarter of it is used.
+ * All slots above 'count' must be free. Returns the (new) table.
+ */
+static void * _TF_FN lst_shrink(void *table, TF_COUNT *cap, TF_COUNT count, size_t size)
+{
+    uint32_t newcap = *cap / 2;
+    void *p;
+
+    if (*cap <= TF_LST_MIN_CAP || count > *cap / 4) return table;
+
+    p = TF_Realloc(table, newcap * size);
+    if (p == NULL) return table;
+
+    *cap = (TF_COUNT) newcap;
+    return p;
+}
+
+static bool _TF_FN grow_id_lst(TinyFrame *tf)
+{
+    void *p = lst_grow(tf->id_listeners, &tf->cap_id_lst, TF_MAX_ID_LST, sizeof(struct TF_IdListener_));
+    if (p == NULL) return false;
+    tf->id_listeners = p;
+    return true;
+}
+
+static bool _TF_FN grow_type_lst(TinyFrame *tf)
+{
+    void *p = lst_grow(tf->type_listeners, &tf->cap_type_lst, TF_MAX_TYPE_LST, sizeof(struct TF_TypeListener_));
+    if (p == NULL) return false;
+    tf->type_listeners = p;
+    return true;
+}
+
+static bool _TF_FN grow_generic_lst(TinyFrame *tf)
+{
+    void *p = lst_grow(tf->generic_listeners, &tf->cap_generic_lst, TF_MAX_GEN_LST, sizeof(struct TF_GenericListener_));
+    if (p == NULL) return false;
+    tf->generic_listeners = p;
+    return true;
+}
+
+/** Release memory of tables that are mostly unused */
+static void _TF_FN shrink_listener_tables(TinyFrame *tf)
+{
+    tf->id_listeners = lst_shrink(tf->id_listeners, &tf->cap_id_lst,
+                                  tf->count_id_lst, sizeof(struct TF_IdListener_));
+    tf->type_listeners = lst_shrink(tf->type_listeners, &tf->cap_type_lst,
+                                    tf->count_type_lst, sizeof(struct TF_TypeListener_));
+    tf->generic_listeners = lst_shrink(tf->generic_listeners, &tf->cap_generic_lst,
+                                       tf->count_generic_lst, sizeof(struct TF_GenericListener_));
+}
+
+#else
+
+#define TF_ID_LST_CAP(tf) TF_MAX_ID_LST
+#define TF_TYPE_LST_CAP(tf) TF_MAX_TYPE_LST
+#define TF_GEN_LST_CAP(tf) TF_MAX_GEN_LST
+
+// The static tables can't grow
+#define grow_id_lst(tf) false
+#define grow_type_lst(tf) false
+#define grow_generic_lst(tf) false
+
+#endif
+
 /** Reset ID listener's timeout to the original value */
 static inline void _TF_FN renew_id_listener(struct TF_IdListener_ *lst)
 {
     lst->timeout = lst->timeout_max;
 }
 
+/** Move the live listeners of a table to its start, keeping their order */
+#define TF_COMPACT_LST(table, count) do { \
+    TF_COUNT r_, w_ = 0; \
+    for (r_ = 0; r_ < (count); r_++) { \
+        if ((table)[r_].fn == NULL) continue; \
+        if (w_ != r_) (table)[w_] = (table)[r_]; \
+        w_++; \
+    } \
+    (count) = w_; \
+} while (0)
+
+#if TF_MAX_RANGE_LST
+
+/**
+ * Build the lookup structure of range and mask listeners.
+ *
+ * The type space is split into segments at the first type of each listener's range and
+ * after its last type. Each segment gets a bitmap of the listeners covering it (bit i
+ * for range_listeners[i]), so a frame's listeners are found by a binary search.
+ * Mask listeners cover the range from the lowest to the highest matching type,
+ * the mask is checked when dispatching.
+ */
+static void _TF_FN compile_range_listeners(TinyFrame *tf)
+{
+    TF_COUNT i, j, n = 0;
+    TF_TYPE b;
+    struct TF_TypeRangeListener_ *lst;
+    uint32_t bits;
+
+    // Collect the segment boundaries, sorted and unique (insertion sort, there's just a few)
+    tf->range_seg_start[n++] = 0;
+    for (i = 0; i < tf->count_range_lst * 2; i++) {
+        lst = &tf->range_listeners[i / 2];
+        if (i % 2 == 0) {
+            b = lst->first;
+        } else {
+            if (lst->last == (TF_TYPE) ~(TF_TYPE) 0) continue; // the range reaches the end
+            b = (TF_TYPE) (lst->last + 1);
+        }
+
+        for (j = n; j > 0 && tf->range_seg_start[j - 1] > b; j--);
+        if (j > 0 && tf->range_seg_start[j - 1] == b) continue; // already there
+        memmove(&tf->range_seg_start[j + 1], &tf->range_seg_start[j], (n - j) * sizeof(TF_TYPE));
+        tf->range_seg_start[j] = b;
+        n++;
+    }
+
+    // Assign the listeners to the segments
+    for (j = 0; j < n; j++) {
+        b = tf->range_seg_start[j];
+        bits = 0;
+        for (i = 0; i < tf->count_range_lst; i++) {
+            lst = &tf->range_listeners[i];
+            if (lst->fn != NULL && b >= lst->first && b <= lst->last) {
+                bits |= (uint32_t) 1 << i;
+            }
+        }
+        tf->range_seg_lst[j] = bits;
+    }
+
+    tf->count_range_seg = n;
+}
+
+/** Find the bitmap of range listeners that may match a frame type */
+static inline uint32_t _TF_FN find_range_listeners(TinyFrame *tf, TF_TYPE type)
+{
+    TF_COUNT lo = 0, hi = (TF_COUNT) (tf->count_range_seg - 1), mid;
+
+    if (tf->count_range_seg == 0) return 0;
+
+    // last segment starting at or below the type
+    while (lo < hi) {
+        mid = (TF_COUNT) ((lo + hi + 1) / 2);
+        if (tf->range_seg_start[mid] <= type) {
+            lo = mid;
+        } else {
+            hi = (TF_COUNT) (mid - 1);
+        }
+    }
+    return tf->range_seg_lst[lo];
+}
+
+#endif
+
+/**
+ * Drop the discarded listeners from the tables.
+ * While the tables are being iterated (tf->lst_busy), this waits until the loops end,
+ * so the listeners don't move under them.
+ */
+static void _TF_FN settle_listeners(TinyFrame *tf)
+{
+    if (tf->lst_busy || !tf->lst_dirty) return;
+
+    TF_COMPACT_LST(tf->id_listeners, tf->count_id_lst);
+    TF_COMPACT_LST(tf->type_listeners, tf->count_type_lst);
+    TF_COMPACT_LST(tf->generic_listeners, tf->count_generic_lst);
+#if TF_MAX_RANGE_LST
+    TF_COMPACT_LST(tf->range_listeners, tf->count_range_lst);
+    compile_range_listeners(tf);
+#endif
+    tf->lst_dirty = false;
+}
+
+/**
+ * Drop slot i of a table after its listener was discarded (fn set to NULL).
+ * The following listeners are shifted down, unless the tables are being iterated.
+ */
+#define TF_DROP_LST(tf, table, count, i) do { \
+    if ((tf)->lst_busy || (tf)->lst_dirty) { \
+        (tf)->lst_dirty = true; \
+        settle_listeners(tf); \
+    } else { \
+        memmove(&(table)[i], &(table)[(i) + 1], ((count) - (i) - 1) * sizeof((table)[0])); \
+        (count)--; \
+    } \
+} while (0)
+
 /** Notify callback about ID listener's demise & let it free any resources in userdata */
-static void _TF_FN cleanup_id_listener(TinyFrame *tf, TF_COUNT i, struct TF_IdListener_ *lst)
+static void _TF_FN cleanup_id_listener(TinyFrame *tf, struct TF_IdListener_ *lst)
 {
     TF_Msg msg;
-    if (lst->fn == NULL) return;
+    TF_Listener fn = lst->fn;
+    TF_COUNT i = (TF_COUNT) (lst - tf->id_listeners);
+    if (fn == NULL) return;
+
+    // Discard listener
+    lst->fn = NULL;
+    lst->fn_timeout = NULL;
 
     // Make user clean up their data - only if not NULL
     if (lst->userdata != NULL || lst->userdata2 != NULL) {
         msg.userdata = lst->userdata;
         msg.userdata2 = lst->userdata2;
         msg.data = NULL; // this is a signal that the listener should clean up
-        lst->fn(tf, &msg); // return value is ignored here - use TF_STAY or TF_CLOSE
-    }
-
-    lst->fn = NULL; // Discard listener
-    lst->fn_timeout = NULL;
 
-    if (i == tf->count_id_lst - 1) {
-        tf->count_id_lst--;
+        // the listener is already discarded, so the callback can't change its slot
+        tf->lst_busy++;
+        fn(tf, &msg); // return value is ignored here - use TF_STAY or TF_CLOSE
+        tf->lst_busy--;
     }
+
+    TF_DROP_LST(tf, tf->id_listeners, tf->count_id_lst, i);
 }
 
 /** Clean up Type listener */
-static inline void _TF_FN cleanup_type_listener(TinyFrame *tf, TF_COUNT i, struct TF_TypeListener_ *lst)
+static inline void _TF_FN cleanup_type_listener(TinyFrame *tf, struct TF_TypeListener_ *lst)
 {
+    TF_COUNT i = (TF_COUNT) (lst - tf->type_listeners);
     lst->fn = NULL; // Discard listener
-    if (i == tf->count_type_lst - 1) {
-        tf->count_type_lst--;
-    }
+    TF_DROP_LST(tf, tf->type_listeners, tf->count_type_lst, i);
 }
 
 /** Clean up Generic listener */
-static inline void _TF_FN cleanup_generic_listener(TinyFrame *tf, TF_COUNT i, struct TF_GenericListener_ *lst)
+static inline void _TF_FN cleanup_generic_listener(TinyFrame *tf, struct TF_GenericListener_ *lst)
 {
+    TF_COUNT i = (TF_COUNT) (lst - tf->generic_listeners);
     lst->fn = NULL; // Discard listener
-    if (i == tf->count_generic_lst - 1) {
-        tf->count_generic_lst--;
-    }
+    TF_DROP_LST(tf, tf->generic_listeners, tf->count_generic_lst, i);
 }
 
 /** Add a new ID listener. Returns 1 on success. */
@@ -307,25 +615,22 @@ bool _TF_FN TF_AddIdListener(TinyFrame *tf, TF_Msg *msg, TF_Listener cb, TF_List
 {
     TF_COUNT i;
     struct TF_IdListener_ *lst;
-    for (i = 0; i < TF_MAX_ID_LST; i++) {
-        lst = &tf->id_listeners[i];
-        // test for empty slot
-        if (lst->fn == NULL) {
-            lst->fn = cb;
-            lst->fn_timeout = ftimeout;
-            lst->id = msg->frame_id;
-            lst->userdata = msg->userdata;
-            lst->userdata2 = msg->userdata2;
-            lst->timeout_max = lst->timeout = timeout;
-            if (i >= tf->count_id_lst) {
-                tf->count_id_lst = (TF_COUNT) (i + 1);
-            }
-            return true;
-        }
+    // the live listeners are at the start of the table, append after them
+    i = tf->count_id_lst;
+    if (i == TF_ID_LST_CAP(tf) && !grow_id_lst(tf)) {
+        TF_Error("Failed to add ID listener");
+        return false;
     }
 
-    TF_Error("Failed to add ID listener");
-    return false;
+    lst = &tf->id_listeners[i];
+    lst->fn = cb;
+    lst->fn_timeout = ftimeout;
+    lst->id = msg->frame_id;
+    lst->userdata = msg->userdata;
+    lst->userdata2 = msg->userdata2;
+    lst->timeout_max = lst->timeout = timeout;
+    tf->count_id_lst++;
+    return true;
 }
 
 /** Add a new Type listener. Returns 1 on success. */
@@ -333,21 +638,21 @@ bool _TF_FN TF_AddTypeListener(TinyFrame *tf, TF_TYPE frame_type, TF_Listener cb
 {
     TF_COUNT i;
     struct TF_TypeListener_ *lst;
-    for (i = 0; i < TF_MAX_TYPE_LST; i++) {
-        lst = &tf->type_listeners[i];
-        // test for empty slot
-        if (lst->fn == NULL) {
-            lst->fn = cb;
-            lst->type = frame_type;
-            if (i >= tf->count_type_lst) {
-                tf->count_type_lst = (TF_COUNT) (i + 1);
-            }
-            return true;
-        }
+    // the live listeners are at the start of the table, append after them
+    i = tf->count_type_lst;
+    if (i == TF_TYPE_LST_CAP(tf) && !grow_type_lst(tf)) {
+        TF_Error("Failed to add type listener");
+        return false;
     }
 
-    TF_Error("Failed to add type listener");
-    return false;
+    lst = &tf->type_listeners[i];
+    lst->fn = cb;
+    lst->type = frame_type;
+#if TF_USE_RX_FILTER
+    lst->max_len = 0;
+#endif
+    tf->count_type_lst++;
+    return true;
 }
 
 /** Add a new Generic listener. Returns 1 on success. */
@@ -355,20 +660,17 @@ bool _TF_FN TF_AddGenericListener(TinyFrame *tf, TF_Listener cb)
 {
     TF_COUNT i;
     struct TF_GenericListener_ *lst;
-    for (i = 0; i < TF_MAX_GEN_LST; i++) {
-        lst = &tf->generic_listeners[i];
-        // test for empty slot
-        if (lst->fn == NULL) {
-            lst->fn = cb;
-            if (i >= tf->count_generic_lst) {
-                tf->count_generic_lst = (TF_COUNT) (i + 1);
-            }
-            return true;
-        }
+    // the live listeners are at the start of the table, append after them
+    i = tf->count_generic_lst;
+    if (i == TF_GEN_LST_CAP(tf) && !grow_generic_lst(tf)) {
+        TF_Error("Failed to add generic listener");
+        return false;
     }
 
-    TF_Error("Failed to add generic listener");
-    return false;
+    lst = &tf->generic_listeners[i];
+    lst->fn = cb;
+    tf->count_generic_lst++;
+    return true;
 }
 
 /** Remove a ID listener by its frame ID. Returns 1 on success. */
@@ -380,7 +682,7 @@ bool _TF_FN TF_RemoveIdListener(TinyFrame *tf, TF_ID frame_id)
         lst = &tf->id_listeners[i];
         // test if live & matching
         if (lst->fn != NULL && lst->id == frame_id) {
-            cleanup_id_listener(tf, i, lst);
+            cleanup_id_listener(tf, lst);
             return true;
         }
     }
@@ -398,7 +700,7 @@ bool _TF_FN TF_RemoveTypeListener(TinyFrame *tf, TF_TYPE type)
         lst = &tf->type_listeners[i];
         // test if live & matching
         if (lst->fn != NULL    && lst->type == type) {
-            cleanup_type_listener(tf, i, lst);
+            cleanup_type_listener(tf, lst);
             return true;
         }
     }
@@ -407,6 +709,94 @@ bool _TF_FN TF_RemoveTypeListener(TinyFrame *tf, TF_TYPE type)
     return false;
 }
 
+#if TF_MAX_RANGE_LST
+
+/** Add a range listener with a mask */
+static bool _TF_FN add_range_listener(TinyFrame *tf, TF_TYPE first, TF_TYPE last,
+                                      TF_TYPE value, TF_TYPE mask, TF_Listener cb)
+{
+    struct TF_TypeRangeListener_ *lst;
+
+    if (tf->count_range_lst == TF_MAX_RANGE_LST) {
+        TF_Error("Failed to add type range listener");
+        return false;
+    }
+
+    lst = &tf->range_listeners[tf->count_range_lst++];
+    lst->first = first;
+    lst->last = last;
+    lst->value = value;
+    lst->mask = mask;
+    lst->fn = cb;
+
+    // The lookup can't change while it's being used, it's rebuilt afterwards
+    if (tf->lst_busy) {
+        tf->lst_dirty = true;
+    } else {
+        compile_range_listeners(tf);
+    }
+    return true;
+}
+
+/** Remove a range listener with the given parameters */
+static bool _TF_FN remove_range_listener(TinyFrame *tf, TF_TYPE first, TF_TYPE last,
+                                         TF_TYPE value, TF_TYPE mask)
+{
+    TF_COUNT i;
+    struct TF_TypeRangeListener_ *lst;
+    for (i = 0; i < tf->count_range_lst; i++) {
+        lst = &tf->range_listeners[i];
+        // test if live & matching
+        if (lst->fn != NULL && lst->first == first && lst->last == last
+            && lst->value == value && lst->mask == mask) {
+            lst->fn = NULL;
+            tf->lst_dirty = true;
+            settle_listeners(tf);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Add a new Type Range listener. Returns 1 on success. */
+bool _TF_FN TF_AddTypeRangeListener(TinyFrame *tf, TF_TYPE first, TF_TYPE last, TF_Listener cb)
+{
+    if (first > last) {
+        TF_Error("Bad type range");
+        return false;
+    }
+    return add_range_listener(tf, first, last, 0, 0, cb);
+}
+
+/** Add a new Type Mask listener. Returns 1 on success. */
+bool _TF_FN TF_AddTypeMaskListener(TinyFrame *tf, TF_TYPE value, TF_TYPE mask, TF_Listener cb)
+{
+    // the matching types lie between value (other bits 0) and value with all the other bits 1
+    value &= mask;
+    return add_range_listener(tf, value, (TF_TYPE) (value | ~mask), value, mask, cb);
+}
+
+/** Remove a Type Range listener. Returns 1 on success. */
+bool _TF_FN TF_RemoveTypeRangeListener(TinyFrame *tf, TF_TYPE first, TF_TYPE last)
+{
+    if (remove_range_listener(tf, first, last, 0, 0)) return true;
+
+    TF_Error("Type range listener %d-%d to remove not found", (int)first, (int)last);
+    return false;
+}
+
+/** Remove a Type Mask listener. Returns 1 on success. */
+bool _TF_FN TF_RemoveTypeMaskListener(TinyFrame *tf, TF_TYPE value, TF_TYPE mask)
+{
+    value &= mask;
+    if (remove_range_listener(tf, value, (TF_TYPE) (value | ~mask), value, mask)) return true;
+
+    TF_Error("Type mask listener %d/%d to remove not found", (int)value, (int)mask);
+    return false;
+}
+
+#endif
+
 /** Remove a generic listener by its function pointer. Returns 1 on success. */
 bool _TF_FN TF_RemoveGenericListener(TinyFrame *tf, TF_Listener cb)
 {
@@ -416,7 +806,7 @@ bool _TF_FN TF_RemoveGenericListener(TinyFrame *tf, TF_Listener cb)
         lst = &tf->generic_listeners[i];
         // test if live & matching
         if (lst->fn == cb) {
-            cleanup_generic_listener(tf, i, lst);
+            cleanup_generic_listener(tf, lst);
             return true;
         }
     }
@@ -425,8 +815,8 @@ bool _TF_FN TF_RemoveGenericListener(TinyFrame *tf, TF_Listener cb)
     return false;
 }
 
-/** Handle a message that was just collected & verified by the parser */
-static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
+/** Pass a received message to the listeners */
+static void _TF_FN TF_DispatchMessage(TinyFrame *tf)
 {
     TF_COUNT i;
     struct TF_IdListener_ *ilst;
@@ -440,13 +830,16 @@ static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
     msg.frame_id = tf->id;
     msg.is_response = false;
     msg.type = tf->type;
-    msg.data = tf->data;
+    msg.data = TF_RX_PAYLOAD(tf);
     msg.len = tf->len;
+#if TF_ADDR_BYTES
+    msg.addr = tf->rx_addr;
+#endif
 
     // Any listener can consume the message, or let someone else handle it.
 
-    // The loop upper bounds are the highest currently used slot index
-    // (or close to it, depending on the order of listener removals).
+    // The live listeners are at the start of the tables. Listeners removed in the
+    // callbacks are only marked (fn = NULL) and dropped when the dispatch ends.
 
     // ID listeners first
     for (i = 0; i < tf->count_id_lst; i++) {
@@ -456,6 +849,7 @@ static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
             msg.userdata = ilst->userdata; // pass userdata pointer to the callback
             msg.userdata2 = ilst->userdata2;
             res = ilst->fn(tf, &msg);
+            ilst = &tf->id_listeners[i]; // the table may have been reallocated by the callback
             ilst->userdata = msg.userdata; // put it back (may have changed the pointer or set to NULL)
             ilst->userdata2 = msg.userdata2; // put it back (may have changed the pointer or set to NULL)
 
@@ -468,7 +862,7 @@ static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
                     // Set userdata to NULL to avoid calling user for cleanup
                     ilst->userdata = NULL;
                     ilst->userdata2 = NULL;
-                    cleanup_id_listener(tf, i, ilst);
+                    cleanup_id_listener(tf, ilst);
                 }
                 return;
             }
@@ -485,25 +879,53 @@ static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
 
         if (tlst->fn && tlst->type == msg.type) {
             res = tlst->fn(tf, &msg);
+            tlst = &tf->type_listeners[i];
 
             if (res != TF_NEXT) {
                 // type listeners don't have userdata.
                 // TF_RENEW doesn't make sense here because type listeners don't expire = same as TF_STAY
 
                 if (res == TF_CLOSE) {
-                    cleanup_type_listener(tf, i, tlst);
+                    cleanup_type_listener(tf, tlst);
                 }
                 return;
             }
         }
     }
 
+#if TF_MAX_RANGE_LST
+    // Range and mask listeners
+    {
+        struct TF_TypeRangeListener_ *rlst;
+        uint32_t bits = find_range_listeners(tf, msg.type);
+
+        for (i = 0; bits != 0; i++, bits >>= 1) {
+            if (!(bits & 1)) continue;
+            rlst = &tf->range_listeners[i];
+
+            if (rlst->fn && (msg.type & rlst->mask) == rlst->value) {
+                res = rlst->fn(tf, &msg);
+
+                if (res != TF_NEXT) {
+                    // like type listeners, those don't expire
+                    if (res == TF_CLOSE) {
+                        tf->range_listeners[i].fn = NULL; // dropped when the dispatch ends
+                        tf->lst_dirty = true;
+                    }
+                    return;
+                }
+            }
+        }
+    }
+#endif
+
     // Generic listeners
     for (i = 0; i < tf->count_generic_lst; i++) {
         glst = &tf->generic_listeners[i];
 
         if (glst->fn) {
             res = glst->fn(tf, &msg);
+            glst = &tf->generic_listeners[i];
 
             if (res != TF_NEXT) {
                 // generic listeners don't have userdata.
@@ -514,7 +936,7 @@ static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
                 // handled the message.
 
                 if (res == TF_CLOSE) {
-                    cleanup_generic_listener(tf, i, glst);
+                    cleanup_generic_listener(tf, glst);
                 }
                 return;
             }
@@ -524,6 +946,20 @@ static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
     TF_Error("Unhandled message, type %d", (int)msg.type);
 }
 
+/** Handle a message that was just collected & verified by the parser */
+static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
+{
+#if TF_USE_STREAM_RX
+    // The payload was already handled by the stream listener
+    if (tf->streaming) return;
+#endif
+
+    tf->lst_busy++;
+    TF_DispatchMessage(tf);
+    tf->lst_busy--;
+    settle_listeners(tf);
+}
+
 /** Externally renew an ID listener */
 bool _TF_FN TF_RenewIdListener(TinyFrame *tf, TF_ID id)
 {
@@ -547,14 +983,64 @@ bool _TF_FN TF_RenewIdListener(TinyFrame *tf, TF_ID id)
 
 //region Parser
 
-/** Handle a received byte buffer */
-void _TF_FN TF_Accept(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
+#if TF_RX_RING_LEN
+/** Push a received byte to the Rx ring */
+bool _TF_FN TF_RxPush(TinyFrame *tf, uint8_t c)
 {
-    uint32_t i;
-    for (i = 0; i < count; i++) {
-        TF_AcceptChar(tf, buffer[i]);
+    uint32_t head = tf->rx_ring_head;
+
+    if (head - tf->rx_ring_tail == TF_RX_RING_LEN) {
+        return false; // full
+    }
+
+    tf->rx_ring[head & (TF_RX_RING_LEN - 1)] = c;
+    TF_Barrier(); // the byte must be stored before it's published
+    tf->rx_ring_head = head + 1;
+    return true;
+}
+
+/** Push received bytes to the Rx ring */
+uint32_t _TF_FN TF_RxPushBuf(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
+{
+    uint32_t head = tf->rx_ring_head;
+    uint32_t pos = head & (TF_RX_RING_LEN - 1);
+    uint32_t chunk;
+
+    count = TF_MIN(count, TF_RX_RING_LEN - (head - tf->rx_ring_tail));
+
+    // up to the end of the ring, then the rest from the start
+    chunk = TF_MIN(count, TF_RX_RING_LEN - pos);
+    memcpy(tf->rx_ring + pos, buffer, chunk);
+    memcpy(tf->rx_ring, buffer + chunk, count - chunk);
+
+    TF_Barrier();
+    tf->rx_ring_head = head + count;
+    return count;
+}
+
+/** Parse the bytes waiting in the Rx ring */
+uint32_t _TF_FN TF_Process(TinyFrame *tf)
+{
+    uint32_t tail = tf->rx_ring_tail;
+    uint32_t count = tf->rx_ring_head - tail;
+    uint32_t pos = tail & (TF_RX_RING_LEN - 1);
+    uint32_t chunk;
+
+    if (count == 0) return 0;
+    TF_Barrier(); // see the bytes published with the head
+
+    // The bytes are in at most two spans, parse them in bulk
+    chunk = TF_MIN(count, TF_RX_RING_LEN - pos);
+    TF_Accept(tf, tf->rx_ring + pos, chunk);
+    if (count > chunk) {
+        TF_Accept(tf, tf->rx_ring, count - chunk);
     }
+
+    TF_Barrier(); // done reading before the space is given back
+    tf->rx_ring_tail = tail + count;
+    return count;
 }
+#endif
 
 /** Reset the parser's internal state. */
 void _TF_FN TF_ResetParser(TinyFrame *tf)
@@ -572,34 +1058,385 @@ static void _TF_FN pars_begin_frame(TinyFrame *tf) {
 #endif
 
     tf->discard_data = false;
+#if TF_USE_STREAM_RX
+    tf->streaming = false;
+#endif
+#if TF_USE_RX_DEST
+    tf->rx_dest = tf->data;
+#endif
+#if TF_USE_FAST_PARSER && !TF_USE_STREAM_RX
+    tf->rx_inplace = NULL;
+#endif
 
-    // Enter ID state
+    // Enter ID state (or ADDR, which comes first)
+#if TF_ADDR_BYTES
+    tf->state = TFState_ADDR;
+#else
     tf->state = TFState_ID;
+#endif
     tf->rxi = 0;
 }
 
-/** Handle a received char - here's the main state machine */
-void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
+#if TF_ADDR_BYTES
+/** Set the own address */
+void _TF_FN TF_SetAddress(TinyFrame *tf, TF_ADDR addr)
 {
-    // Parser timeout - clear
-    if (tf->parser_timeout_ticks >= TF_PARSER_TIMEOUT_TICKS) {
-        if (tf->state != TFState_SOF) {
-            TF_ResetParser(tf);
-            TF_Error("Parser timeout");
-        }
-    }
-    tf->parser_timeout_ticks = 0;
+    tf->addr = addr;
+}
 
-// DRY snippet - collect multi-byte number from the input stream, byte by byte
-// This is a little dirty, but makes the code easier to read. It's used like e.g. if(),
-// the body is run only after the entire number (of data type 'type') was received
-// and stored to 'dest'
-#define COLLECT_NUMBER(dest, type) dest = (type)(((dest) << 8) | c); \
-                                   if (++tf->rxi == sizeof(type))
+/** Check if the frame is addressed to us */
+static inline bool _TF_FN pars_addr_match(TinyFrame *tf)
+{
+    return tf->rx_addr == tf->addr || tf->rx_addr == TF_ADDR_BROADCAST || tf->addr == TF_ADDR_BROADCAST;
+}
+#endif
 
-#if !TF_USE_SOF_BYTE
-    if (tf->state == TFState_SOF) {
-        pars_begin_frame(tf);
+#if TF_USE_RX_FILTER
+/** Set the Rx filter */
+void _TF_FN TF_SetRxFilter(TinyFrame *tf, TF_RxFilter cb)
+{
+    tf->rx_filter = cb;
+}
+
+/** Check if a frame would be handled by a listener */
+bool _TF_FN TF_HasListener(TinyFrame *tf, TF_Msg *msg)
+{
+    TF_COUNT i;
+
+    // Removed listeners stay in the tables until they're compacted, skip them like the dispatch does
+    for (i = 0; i < tf->count_generic_lst; i++) {
+        if (tf->generic_listeners[i].fn) return true;
+    }
+#if TF_USE_STREAM_RX
+    if (tf->stream_lst != NULL) return true;
+#endif
+
+    for (i = 0; i < tf->count_id_lst; i++) {
+        if (tf->id_listeners[i].fn && tf->id_listeners[i].id == msg->frame_id) return true;
+    }
+
+    for (i = 0; i < tf->count_type_lst; i++) {
+        if (tf->type_listeners[i].fn && tf->type_listeners[i].type == msg->type) return true;
+    }
+
+#if TF_MAX_RANGE_LST
+    {
+        uint32_t bits = find_range_listeners(tf, msg->type);
+        for (i = 0; bits != 0; i++, bits >>= 1) {
+            if ((bits & 1) && tf->range_listeners[i].fn
+                && (msg->type & tf->range_listeners[i].mask) == tf->range_listeners[i].value) {
+                return true;
+            }
+        }
+    }
+#endif
+
+    return false;
+}
+
+/** Set the longest payload accepted for a frame type */
+bool _TF_FN TF_SetTypeMaxLen(TinyFrame *tf, TF_TYPE frame_type, TF_LEN max_len)
+{
+    TF_COUNT i;
+    for (i = 0; i < tf->count_type_lst; i++) {
+        if (tf->type_listeners[i].fn && tf->type_listeners[i].type == frame_type) {
+            tf->type_listeners[i].max_len = max_len;
+            return true;
+        }
+    }
+
+    TF_Error("Type listener %d to limit not found", (int)frame_type);
+    return false;
+}
+
+/** The header was received - check if the frame is wanted. Returns false to skip it. */
+static bool _TF_FN pars_filter_frame(TinyFrame *tf)
+{
+    TF_Msg msg;
+    TF_COUNT i;
+
+    for (i = 0; i < tf->count_type_lst; i++) {
+        if (tf->type_listeners[i].fn && tf->type_listeners[i].type == tf->type && tf->type_listeners[i].max_len != 0
+            && tf->len > tf->type_listeners[i].max_len) {
+            TF_Error("Rx payload too long for type %d: %d", (int)tf->type, (int)tf->len);
+            return false;
+        }
+    }
+
+    if (tf->rx_filter == NULL) return true;
+
+    TF_ClearMsg(&msg);
+    msg.frame_id = tf->id;
+    msg.type = tf->type;
+    msg.data = NULL;
+    msg.len = tf->len;
+#if TF_ADDR_BYTES
+    msg.addr = tf->rx_addr;
+#endif
+    return tf->rx_filter(tf, &msg);
+}
+#endif
+
+#if TF_USE_RX_DEST
+/** Set the Rx destination callback */
+void _TF_FN TF_SetRxDest(TinyFrame *tf, TF_RxDest cb)
+{
+    tf->rx_dest_fn = cb;
+}
+
+/** The header was received - ask where to store the payload */
+static void _TF_FN pars_choose_dest(TinyFrame *tf)
+{
+    TF_Msg msg;
+    uint8_t *dest;
+
+    TF_ClearMsg(&msg);
+    msg.frame_id = tf->id;
+    msg.type = tf->type;
+    msg.data = NULL;
+    msg.len = tf->len;
+#if TF_ADDR_BYTES
+    msg.addr = tf->rx_addr;
+#endif
+
+    dest = tf->rx_dest_fn(tf, &msg);
+    if (dest != NULL) {
+        tf->rx_dest = dest;
+    }
+}
+#endif
+
+#if TF_USE_STREAM_RX
+/** Set the stream listener */
+void _TF_FN TF_SetStreamListener(TinyFrame *tf, TF_Listener cb, TF_StreamRead read)
+{
+    tf->stream_lst = cb;
+    tf->stream_read = read;
+}
+
+/** Get the next piece of the payload of the frame being streamed */
+const uint8_t * _TF_FN TF_StreamChunk(TinyFrame *tf, uint32_t max, uint32_t *len)
+{
+    const uint8_t *chunk;
+    uint32_t n;
+
+    n = TF_MIN(max, (uint32_t) (tf->len - tf->rxi));
+    if (!tf->streaming || n == 0) {
+        *len = 0;
+        return NULL;
+    }
+
+    if (tf->stream_buf_len > 0) {
+        // Take bytes given to TF_Accept()
+        n = TF_MIN(n, tf->stream_buf_len);
+        chunk = tf->stream_buf;
+        tf->stream_buf += n;
+        tf->stream_buf_len -= n;
+    }
+    else {
+        // Pull more bytes using the read function
+        n = TF_MIN(n, TF_MAX_PAYLOAD_RX);
+        if (tf->stream_read != NULL) {
+            n = tf->stream_read(tf, tf->data, n);
+        } else {
+            n = 0;
+        }
+
+        if (n == 0) {
+            *len = 0;
+            return NULL;
+        }
+        chunk = tf->data;
+    }
+
+    CKSUM_ADD_BLOCK(tf->cksum, chunk, n);
+    tf->rxi += n;
+
+    *len = n;
+    return chunk;
+}
+
+/** Let the stream listener handle the payload of the frame. Returns true if it did. */
+static bool _TF_FN pars_stream_payload(TinyFrame *tf)
+{
+    TF_Msg msg;
+    TF_Result res;
+
+    TF_ClearMsg(&msg);
+    msg.frame_id = tf->id;
+    msg.type = tf->type;
+    msg.data = NULL;
+    msg.len = tf->len;
+#if TF_ADDR_BYTES
+    msg.addr = tf->rx_addr;
+#endif
+
+    tf->streaming = true;
+    res = tf->stream_lst(tf, &msg);
+
+    if (res == TF_NEXT && tf->rxi == 0) {
+        // Not interested, receive the frame normally
+        tf->streaming = false;
+        return false;
+    }
+
+    if (res == TF_CLOSE) {
+        tf->stream_lst = NULL;
+    }
+
+    if (tf->rxi == tf->len) {
+        // The listener read all the payload
+        #if TF_CKSUM_TYPE == TF_CKSUM_NONE
+            TF_ResetParser(tf);
+        #else
+            tf->state = TFState_DATA_CKSUM;
+            tf->rxi = 0;
+            tf->ref_cksum = 0;
+        #endif
+    }
+    return true;
+}
+#endif
+
+/** Parser timeout - clear the unfinished frame */
+static inline void _TF_FN pars_check_timeout(TinyFrame *tf)
+{
+    if (tf->parser_timeout_ticks >= TF_PARSER_TIMEOUT_TICKS) {
+        if (tf->state != TFState_SOF) {
+            TF_ResetParser(tf);
+            TF_Error("Parser timeout");
+        }
+    }
+    tf->parser_timeout_ticks = 0;
+}
+
+/** The header was received and verified - decide what to do with the payload */
+static void _TF_FN pars_head_done(TinyFrame *tf)
+{
+#if TF_ADDR_BYTES
+    if (!pars_addr_match(tf)) {
+        // For another node - consume, but do not store or checksum the payload.
+        tf->discard_data = true;
+    }
+#endif
+
+#if TF_USE_RX_FILTER
+    if (!tf->discard_data && !pars_filter_frame(tf)) {
+        // Not wanted - consume, but do not store or checksum the payload.
+        tf->discard_data = true;
+    }
+#endif
+
+    if (tf->len == 0) {
+        // if the message has no body, we're done.
+        if (!tf->discard_data) TF_HandleReceivedMessage(tf);
+        TF_ResetParser(tf);
+        return;
+    }
+
+    // Enter DATA state
+    tf->state = TFState_DATA;
+    tf->rxi = 0;
+
+    CKSUM_RESET(tf->cksum); // Start collecting the payload
+
+    if (tf->discard_data) {
+        return;
+    }
+
+#if TF_USE_STREAM_RX
+    if (tf->stream_lst != NULL && pars_stream_payload(tf)) {
+        return;
+    }
+#endif
+
+#if TF_USE_RX_DEST
+    if (tf->rx_dest_fn != NULL) {
+        pars_choose_dest(tf);
+    }
+#endif
+
+    if (tf->len > TF_MAX_PAYLOAD_RX && TF_RX_BUF(tf) == tf->data) {
+        TF_Error("Rx payload too long: %d", (int)tf->len);
+        // ERROR - frame too long. Consume, but do not store.
+        tf->discard_data = true;
+    }
+}
+
+/** The header checksum was received - check it */
+static void _TF_FN pars_head_cksum_done(TinyFrame *tf)
+{
+    // Check the header checksum against the computed value
+    CKSUM_FINALIZE(tf->cksum);
+
+    if (tf->cksum != tf->ref_cksum) {
+        TF_Error("Rx head cksum mismatch");
+        TF_ResetParser(tf);
+        return;
+    }
+
+    pars_head_done(tf);
+}
+
+/** The type, last field of the header, was received */
+static inline void _TF_FN pars_type_done(TinyFrame *tf)
+{
+#if TF_CKSUM_TYPE == TF_CKSUM_NONE
+    pars_head_done(tf);
+#else
+    // enter HEAD_CKSUM state
+    tf->state = TFState_HEAD_CKSUM;
+    tf->rxi = 0;
+    tf->ref_cksum = 0;
+#endif
+}
+
+/** The payload was received */
+static inline void _TF_FN pars_data_done(TinyFrame *tf)
+{
+#if TF_CKSUM_TYPE == TF_CKSUM_NONE
+    // All done
+    if (!tf->discard_data) TF_HandleReceivedMessage(tf);
+    TF_ResetParser(tf);
+#else
+    // Enter DATA_CKSUM state
+    tf->state = TFState_DATA_CKSUM;
+    tf->rxi = 0;
+    tf->ref_cksum = 0;
+#endif
+}
+
+/** The payload checksum was received - check it and handle the frame */
+static void _TF_FN pars_data_cksum_done(TinyFrame *tf)
+{
+    // Check the payload checksum against the computed value
+    CKSUM_FINALIZE(tf->cksum);
+    if (!tf->discard_data) {
+        if (tf->cksum == tf->ref_cksum) {
+            TF_HandleReceivedMessage(tf);
+        } else {
+            TF_Error("Body cksum mismatch");
+        }
+    }
+
+    TF_ResetParser(tf);
+}
+
+/** Handle a received char - here's the main state machine */
+void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
+{
+    pars_check_timeout(tf);
+
+// DRY snippet - collect multi-byte number from the input stream, byte by byte
+// This is a little dirty, but makes the code easier to read. It's used like e.g. if(),
+// the body is run only after the entire number (of data type 'type') was received
+// and stored to 'dest'
+#define COLLECT_NUMBER(dest, type) dest = (type)(((dest) << 8) | c); \
+                                   if (++tf->rxi == sizeof(type))
+
+#if !TF_USE_SOF_BYTE
+    if (tf->state == TFState_SOF) {
+        pars_begin_frame(tf);
     }
 #endif
 
@@ -611,6 +1448,17 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
             }
             break;
 
+#if TF_ADDR_BYTES
+        case TFState_ADDR:
+            CKSUM_ADD(tf->cksum, c);
+            COLLECT_NUMBER(tf->rx_addr, TF_ADDR) {
+                // Enter ID state
+                tf->state = TFState_ID;
+                tf->rxi = 0;
+            }
+            break;
+#endif
+
         case TFState_ID:
             CKSUM_ADD(tf->cksum, c);
             COLLECT_NUMBER(tf->id, TF_ID) {
@@ -632,91 +1480,330 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
         case TFState_TYPE:
             CKSUM_ADD(tf->cksum, c);
             COLLECT_NUMBER(tf->type, TF_TYPE) {
-                #if TF_CKSUM_TYPE == TF_CKSUM_NONE
-                    tf->state = TFState_DATA;
-                    tf->rxi = 0;
-                #else
-                    // enter HEAD_CKSUM state
-                    tf->state = TFState_HEAD_CKSUM;
-                    tf->rxi = 0;
-                    tf->ref_cksum = 0;
-                #endif
+                pars_type_done(tf);
             }
             break;
 
         case TFState_HEAD_CKSUM:
             COLLECT_NUMBER(tf->ref_cksum, TF_CKSUM) {
-                // Check the header checksum against the computed value
-                CKSUM_FINALIZE(tf->cksum);
-
-                if (tf->cksum != tf->ref_cksum) {
-                    TF_Error("Rx head cksum mismatch");
-                    TF_ResetParser(tf);
-                    break;
-                }
-
-                if (tf->len == 0) {
-                    // if the message has no body, we're done.
-                    TF_HandleReceivedMessage(tf);
-                    TF_ResetParser(tf);
-                    break;
-                }
-
-                // Enter DATA state
-                tf->state = TFState_DATA;
-                tf->rxi = 0;
-
-                CKSUM_RESET(tf->cksum); // Start collecting the payload
-
-                if (tf->len > TF_MAX_PAYLOAD_RX) {
-                    TF_Error("Rx payload too long: %d", (int)tf->len);
-                    // ERROR - frame too long. Consume, but do not store.
-                    tf->discard_data = true;
-                }
+                pars_head_cksum_done(tf);
             }
             break;
 
         case TFState_DATA:
             if (tf->discard_data) {
                 tf->rxi++;
-            } else {
+            }
+#if TF_USE_STREAM_RX
+            else if (tf->streaming) {
+                // Payload handled by the stream listener, only checksum the rest
                 CKSUM_ADD(tf->cksum, c);
-                tf->data[tf->rxi++] = c;
+                tf->rxi++;
+            }
+#endif
+            else {
+                CKSUM_ADD(tf->cksum, c);
+                TF_RX_BUF(tf)[tf->rxi++] = c;
             }
 
             if (tf->rxi == tf->len) {
-                #if TF_CKSUM_TYPE == TF_CKSUM_NONE
-                    // All done
-                    TF_HandleReceivedMessage(tf);
-                    TF_ResetParser(tf);
-                #else
-                    // Enter DATA_CKSUM state
-                    tf->state = TFState_DATA_CKSUM;
-                    tf->rxi = 0;
-                    tf->ref_cksum = 0;
-                #endif
+                pars_data_done(tf);
             }
             break;
 
         case TFState_DATA_CKSUM:
             COLLECT_NUMBER(tf->ref_cksum, TF_CKSUM) {
-                // Check the header checksum against the computed value
-                CKSUM_FINALIZE(tf->cksum);
-                if (!tf->discard_data) {
-                    if (tf->cksum == tf->ref_cksum) {
-                        TF_HandleReceivedMessage(tf);
-                    } else {
-                        TF_Error("Body cksum mismatch");
-                    }
-                }
-
-                TF_ResetParser(tf);
+                pars_data_cksum_done(tf);
             }
             break;
     }
     //@formatter:on
 }
 
+#if TF_USE_FAST_PARSER && !TF_USE_STREAM_RX
+// Shorter inputs of TF_Accept() go to TF_AcceptChar(), the fast parser doesn't pay off for them
+#ifndef TF_FAST_PARSER_MIN
+    #define TF_FAST_PARSER_MIN 4
+#endif
+
+/** Read a big-endian number of the given size (1, 2 or 4 bytes) */
+static inline uint32_t _TF_FN pars_load_be(const uint8_t *p, uint32_t size)
+{
+    uint32_t n = 0;
+    uint32_t i;
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // unaligned word loads
+    uint16_t w16;
+    uint32_t w32;
+    if (size == 2) {
+        memcpy(&w16, p, 2);
+        return __builtin_bswap16(w16);
+    }
+    if (size == 4) {
+        memcpy(&w32, p, 4);
+        return __builtin_bswap32(w32);
+    }
+#endif
+
+    for (i = 0; i < size; i++) {
+        n = (n << 8) | p[i];
+    }
+    return n;
+}
+
+/**
+ * The whole header (after SOF) is in the buffer - decode the fields at once,
+ * instead of collecting them byte by byte.
+ *
+ * A header with a bad checksum usually means the SOF was a false one, found in noise
+ * or in the rest of a broken frame. The search for the next SOF then continues right
+ * after it, so a real frame starting within the bogus header isn't lost.
+ *
+ * @return pointer where the parsing continues
+ */
+static inline const uint8_t * _TF_FN pars_head_whole(TinyFrame *tf, const uint8_t *head)
+{
+    const uint8_t *p = head;
+
+    CKSUM_ADD_BLOCK(tf->cksum, head, TF_HEAD_LEN - TF_USE_SOF_BYTE - TF_CKSUM_LEN);
+
+#if TF_ADDR_BYTES
+    tf->rx_addr = (TF_ADDR) pars_load_be(p, sizeof(TF_ADDR));
+    p += sizeof(TF_ADDR);
+#endif
+    tf->id = (TF_ID) pars_load_be(p, sizeof(TF_ID));
+    p += sizeof(TF_ID);
+    tf->len = (TF_LEN) pars_load_be(p, sizeof(TF_LEN));
+    p += sizeof(TF_LEN);
+    tf->type = (TF_TYPE) pars_load_be(p, sizeof(TF_TYPE));
+    p += sizeof(TF_TYPE);
+
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+    tf->ref_cksum = (TF_CKSUM) pars_load_be(p, sizeof(TF_CKSUM));
+    p += sizeof(TF_CKSUM);
+
+    CKSUM_FINALIZE(tf->cksum);
+    if (tf->cksum != tf->ref_cksum) {
+        TF_Error("Rx head cksum mismatch");
+        TF_ResetParser(tf);
+        return TF_USE_SOF_BYTE ? head : p; // resync right after the false SOF
+    }
+#endif
+
+    pars_head_done(tf);
+    return p;
+}
+
+/**
+ * The rest of the frame (payload and checksum) is in the buffer - verify the checksum
+ * over it in one pass and hand the payload to the listeners in place, without storing it.
+ * A corrupted frame is dropped without copying anything.
+ *
+ * @return pointer after the frame
+ */
+static inline const uint8_t * _TF_FN pars_body_whole(TinyFrame *tf, const uint8_t *p)
+{
+    const uint8_t *end = p + tf->len + TF_CKSUM_LEN;
+
+    CKSUM_ADD_BLOCK(tf->cksum, p, tf->len);
+    tf->rx_inplace = p;
+    tf->rxi = tf->len;
+
+#if TF_CKSUM_TYPE == TF_CKSUM_NONE
+    pars_data_done(tf);
+#else
+    tf->ref_cksum = (TF_CKSUM) pars_load_be(p + tf->len, sizeof(TF_CKSUM));
+    pars_data_cksum_done(tf);
+#endif
+    return end;
+}
+
+/**
+ * Parse a buffer, staying in each state for as long as the input lasts.
+ * Used by TF_Accept() if TF_USE_FAST_PARSER is enabled, does the same as
+ * TF_AcceptChar() called for each byte, except for the resync after a bad header
+ * (see pars_head_whole()).
+ *
+ * The state is always read from tf, listeners may change it.
+ */
+static void _TF_FN pars_accept_fast(TinyFrame *tf, const uint8_t *p, const uint8_t *end)
+{
+    uint32_t n;
+
+// Jump to the code of the current state, or return if the input was used up
+#ifdef __GNUC__
+    static const void *const state_labels[] = {
+        [TFState_SOF] = &&st_sof,
+#if TF_ADDR_BYTES
+        [TFState_ADDR] = &&st_addr,
+#endif
+        [TFState_ID] = &&st_id,
+        [TFState_LEN] = &&st_len,
+        [TFState_TYPE] = &&st_type,
+        [TFState_HEAD_CKSUM] = &&st_head_cksum,
+        [TFState_DATA] = &&st_data,
+        [TFState_DATA_CKSUM] = &&st_data_cksum,
+    };
+    #define PARS_NEXT() do { if (p == end) return; goto *state_labels[tf->state]; } while (0)
+#else
+    #define PARS_NEXT() do { if (p == end) return; goto st_dispatch; } while (0)
+#endif
+
+// Collect a multi-byte number, staying here while it's incomplete; returns if the input runs out
+#define PARS_COLLECT(dest, type, add_cksum) do { \
+        while (p != end) { \
+            if (add_cksum) CKSUM_ADD(tf->cksum, *p); \
+            (dest) = (type) (((dest) << 8) | *p++); \
+            if (++tf->rxi == sizeof(type)) break; \
+        } \
+        if (tf->rxi != sizeof(type)) return; \
+    } while (0)
+
+    PARS_NEXT();
+
+#ifndef __GNUC__
+st_dispatch:
+    switch (tf->state) {
+        case TFState_SOF: goto st_sof;
+#if TF_ADDR_BYTES
+        case TFState_ADDR: goto st_addr;
+#endif
+        case TFState_ID: goto st_id;
+        case TFState_LEN: goto st_len;
+        case TFState_TYPE: goto st_type;
+        case TFState_HEAD_CKSUM: goto st_head_cksum;
+        case TFState_DATA: goto st_data;
+        case TFState_DATA_CKSUM: goto st_data_cksum;
+    }
+    return;
+#endif
+
+st_sof:
+#if TF_USE_SOF_BYTE
+    // Skip the noise before the next SOF (memchr() is vectorized in most C libraries)
+    p = memchr(p, TF_SOF_BYTE, (size_t) (end - p));
+    if (p == NULL) return;
+    p++;
+#endif
+    pars_begin_frame(tf);
+    if ((uint32_t) (end - p) >= TF_HEAD_LEN - TF_USE_SOF_BYTE) {
+        p = pars_head_whole(tf, p);
+    }
+    PARS_NEXT();
+
+#if TF_ADDR_BYTES
+st_addr:
+    PARS_COLLECT(tf->rx_addr, TF_ADDR, true);
+    tf->state = TFState_ID;
+    tf->rxi = 0;
+    PARS_NEXT();
+#endif
+
+st_id:
+    PARS_COLLECT(tf->id, TF_ID, true);
+    tf->state = TFState_LEN;
+    tf->rxi = 0;
+    PARS_NEXT();
+
+st_len:
+    PARS_COLLECT(tf->len, TF_LEN, true);
+    tf->state = TFState_TYPE;
+    tf->rxi = 0;
+    PARS_NEXT();
+
+st_type:
+    PARS_COLLECT(tf->type, TF_TYPE, true);
+    pars_type_done(tf);
+    PARS_NEXT();
+
+st_head_cksum:
+    PARS_COLLECT(tf->ref_cksum, TF_CKSUM, false);
+    pars_head_cksum_done(tf);
+    PARS_NEXT();
+
+st_data:
+    if (tf->rxi == 0 && !tf->discard_data && TF_RX_BUF(tf) == tf->data
+        && (uint32_t) (end - p) >= tf->len + TF_CKSUM_LEN) {
+        p = pars_body_whole(tf, p);
+        PARS_NEXT();
+    }
+
+    // As much of the payload as there is, in one go
+    n = TF_MIN((uint32_t) (end - p), (uint32_t) (tf->len - tf->rxi));
+    if (!tf->discard_data) {
+        memcpy(TF_RX_BUF(tf) + tf->rxi, p, n);
+        CKSUM_ADD_BLOCK(tf->cksum, p, n);
+    }
+    p += n;
+    tf->rxi += n;
+    if (tf->rxi == tf->len) {
+        pars_data_done(tf);
+    }
+    PARS_NEXT();
+
+st_data_cksum:
+    PARS_COLLECT(tf->ref_cksum, TF_CKSUM, false);
+    pars_data_cksum_done(tf);
+    PARS_NEXT();
+
+#undef PARS_COLLECT
+#undef PARS_NEXT
+}
+#endif
+
+/** Handle a received byte buffer */
+void _TF_FN TF_Accept(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
+{
+    uint32_t i;
+
+#if TF_USE_FAST_PARSER && !TF_USE_STREAM_RX
+    if (count < TF_FAST_PARSER_MIN) {
+        // A few bytes (e.g. one from a UART interrupt) - faster byte by byte
+        for (i = 0; i < count; i++) {
+            TF_AcceptChar(tf, buffer[i]);
+        }
+        return;
+    }
+
+    pars_check_timeout(tf);
+    pars_accept_fast(tf, buffer, buffer + count);
+#else
+    for (i = 0; i < count; i++) {
+        if (tf->state == TFState_DATA) {
+            // Payload - take it in bulk, the last byte goes through the parser
+            uint32_t n = TF_MIN(count - i, (uint32_t) (tf->len - tf->rxi)) - 1;
+            if (tf->discard_data) {
+                // Skipped payload - just jump over it
+            }
+#if TF_USE_STREAM_RX
+            else if (tf->streaming) {
+                // Handled by the stream listener, only checksum the rest
+                CKSUM_ADD_BLOCK(tf->cksum, buffer + i, n);
+            }
+#endif
+            else {
+                memcpy(TF_RX_BUF(tf) + tf->rxi, buffer + i, n);
+                CKSUM_ADD_BLOCK(tf->cksum, buffer + i, n);
+            }
+            tf->rxi += n;
+            i += n;
+        }
+
+#if TF_USE_STREAM_RX
+        // The rest of the buffer is available to a stream listener
+        tf->stream_buf = buffer + i + 1;
+        tf->stream_buf_len = count - i - 1;
+        TF_AcceptChar(tf, buffer[i]);
+        i = count - 1 - tf->stream_buf_len; // skip what the stream listener consumed
+        tf->stream_buf_len = 0;
+#else
+        TF_AcceptChar(tf, buffer[i]);
+#endif
+    }
+#endif
+}
+
 //endregion Parser
 
 
@@ -802,6 +1889,9 @@ static inline uint32_t _TF_FN TF_ComposeHead(TinyFrame *tf, uint8_t *outbuff, TF
     CKSUM_ADD(cksum, TF_SOF_BYTE);
 #endif
 
+#if TF_ADDR_BYTES
+    WRITENUM_CKSUM(TF_ADDR, msg->addr);
+#endif
     WRITENUM_CKSUM(TF_ID, id);
     WRITENUM_CKSUM(TF_LEN, msg->len);
     WRITENUM_CKSUM(TF_TYPE, msg->type);
@@ -828,17 +1918,10 @@ static inline uint32_t _TF_FN TF_ComposeBody(uint8_t *outbuff,
                                     const uint8_t *data, TF_LEN data_len,
                                     TF_CKSUM *cksum)
 {
-    TF_LEN i = 0;
-    uint8_t b = 0;
-    uint32_t pos = 0;
-
-    for (i = 0; i < data_len; i++) {
-        b = data[i];
-        outbuff[pos++] = b;
-        CKSUM_ADD(*cksum, b);
-    }
+    memcpy(outbuff, data, data_len);
+    CKSUM_ADD_BLOCK(*cksum, data, data_len);
 
-    return pos;
+    return data_len;
 }
 
 /**
@@ -861,6 +1944,47 @@ static inline uint32_t _TF_FN TF_ComposeTail(uint8_t *outbuff, TF_CKSUM *cksum)
     return pos;
 }
 
+/**
+ * Write out the contents of the Tx buffer
+ *
+ * @param tf - instance
+ */
+static inline void _TF_FN TF_SendFrame_Flush(TinyFrame *tf)
+{
+#if TF_USE_PULL_TX
+    // Nowhere to write it - the frame is dropped when it's closed
+    if (!tf->tx_broken) {
+        TF_Error("Tx buffer full, the frame won't be sent");
+        tf->tx_broken = true;
+    }
+#else
+    TF_WriteImpl(tf, (const uint8_t *) tf->sendbuf, tf->tx_pos);
+#endif
+    tf->tx_pos = 0;
+    tf->tx_flushed = true;
+}
+
+#if TF_USE_PULL_TX
+/**
+ * Let the driver pull the frame staged in the Tx buffer, followed by the given bytes
+ *
+ * @param tf - instance
+ * @param data - bytes following the Tx buffer contents, sent from the caller's buffer
+ * @param len - number of bytes
+ * @param cksum - checksum the bytes (with tx_cksum) and send the checksum after them
+ */
+static void _TF_FN TF_SendFrame_Queue(TinyFrame *tf, const uint8_t *data, uint32_t len, bool cksum)
+{
+    tf->tx_out = 0;
+    tf->tx_data = data;
+    tf->tx_data_len = len;
+    tf->tx_data_cksum = cksum;
+
+    TF_Barrier(); // the frame must be ready before the driver sees it
+    tf->tx_pending = true;
+}
+#endif
+
 /**
  * Begin building and sending a frame
  *
@@ -875,8 +1999,18 @@ static bool _TF_FN TF_SendFrame_Begin(TinyFrame *tf, TF_Msg *msg, TF_Listener li
 {
     TF_TRY(TF_ClaimTx(tf));
 
+#if TF_USE_PULL_TX
+    if (tf->tx_pending) {
+        TF_Error("The previous frame wasn't pulled yet");
+        TF_ReleaseTx(tf);
+        return false;
+    }
+    tf->tx_broken = false;
+#endif
+
     tf->tx_pos = (uint32_t) TF_ComposeHead(tf, tf->sendbuf, msg); // frame ID is incremented here if it's not a response
     tf->tx_len = msg->len;
+    tf->tx_flushed = false;
 
     if (listener) {
         if(!TF_AddIdListener(tf, msg, listener, ftimeout, timeout)) {
@@ -913,8 +2047,7 @@ static void _TF_FN TF_SendFrame_Chunk(TinyFrame *tf, const uint8_t *buff, uint32
 
         // Flush if the buffer is full
         if (tf->tx_pos == TF_SENDBUF_LEN) {
-            TF_WriteImpl(tf, (const uint8_t *) tf->sendbuf, tf->tx_pos);
-            tf->tx_pos = 0;
+            TF_SendFrame_Flush(tf);
         }
     }
 }
@@ -930,15 +2063,20 @@ static void _TF_FN TF_SendFrame_End(TinyFrame *tf)
     if (tf->tx_len > 0) {
         // Flush if checksum wouldn't fit in the buffer
         if (TF_SENDBUF_LEN - tf->tx_pos < sizeof(TF_CKSUM)) {
-            TF_WriteImpl(tf, (const uint8_t *) tf->sendbuf, tf->tx_pos);
-            tf->tx_pos = 0;
+            TF_SendFrame_Flush(tf);
         }
 
         // Add checksum, flush what remains to be sent
         tf->tx_pos += TF_ComposeTail(tf->sendbuf + tf->tx_pos, &tf->tx_cksum);
     }
 
+#if TF_USE_PULL_TX
+    if (!tf->tx_broken) {
+        TF_SendFrame_Queue(tf, NULL, 0, false);
+    }
+#else
     TF_WriteImpl(tf, (const uint8_t *) tf->sendbuf, tf->tx_pos);
+#endif
     TF_ReleaseTx(tf);
 }
 
@@ -954,6 +2092,13 @@ static void _TF_FN TF_SendFrame_End(TinyFrame *tf)
  */
 static bool _TF_FN TF_SendFrame(TinyFrame *tf, TF_Msg *msg, TF_Listener listener, TF_Listener_Timeout ftimeout, TF_TICKS timeout)
 {
+#if TF_USE_PULL_TX
+    // The frame is copied to the Tx buffer, it's not written out until pulled
+    if (msg->len > 0 && msg->data != NULL && TF_HEAD_LEN + msg->len + sizeof(TF_CKSUM) > TF_SENDBUF_LEN) {
+        TF_Error("Frame doesn't fit in the Tx buffer, send it with TF_Send_NoCopy()");
+        return false;
+    }
+#endif
     TF_TRY(TF_SendFrame_Begin(tf, msg, listener, ftimeout, timeout));
     if (msg->len == 0 || msg->data != NULL) {
         // Send the payload and checksum only if we're not starting a multi-part frame.
@@ -976,6 +2121,21 @@ bool _TF_FN TF_Send(TinyFrame *tf, TF_Msg *msg)
     return TF_SendFrame(tf, msg, NULL, NULL, 0);
 }
 
+/** send without listener, the payload is read from msg->data until the frame is pulled */
+bool _TF_FN TF_Send_NoCopy(TinyFrame *tf, TF_Msg *msg)
+{
+#if TF_USE_PULL_TX
+    if (msg->len > 0 && msg->data != NULL) {
+        TF_TRY(TF_SendFrame_Begin(tf, msg, NULL, NULL, 0));
+        // The payload is composed when it's pulled
+        TF_SendFrame_Queue(tf, msg->data, msg->len, true);
+        TF_ReleaseTx(tf);
+        return true;
+    }
+#endif
+    return TF_Send(tf, msg);
+}
+
 /** send without listener and struct */
 bool _TF_FN TF_SendSimple(TinyFrame *tf, TF_TYPE type, const uint8_t *data, TF_LEN len)
 {
@@ -1007,10 +2167,61 @@ bool _TF_FN TF_Query(TinyFrame *tf, TF_Msg *msg, TF_Listener listener, TF_Listen
 /** Like TF_Send, but with explicit frame ID (set inside the msg object), use for responses */
 bool _TF_FN TF_Respond(TinyFrame *tf, TF_Msg *msg)
 {
+#if TF_ADDR_BYTES
+    // The received address - the sender's address was not set
+    if (msg->addr == tf->addr || msg->addr == TF_ADDR_BROADCAST) {
+        TF_Error("Response must be addressed to the peer, not %d", (int) msg->addr);
+        return false;
+    }
+#endif
     msg->is_response = true;
     return TF_Send(tf, msg);
 }
 
+/** Send a received frame with another instance, reusing the payload checksum */
+bool _TF_FN TF_Forward(TinyFrame *dst, TinyFrame *src, TF_Msg *msg)
+{
+    int8_t si = 0; // signed small int
+    uint8_t b = 0;
+    uint32_t pos;
+    uint8_t *outbuff = dst->sendbuf;
+
+    (void)si; (void)b; // unused if checksums are disabled
+
+#if TF_USE_PULL_TX
+    // The payload is checksummed when it's pulled, the received checksum can't be used
+    (void)src; (void)si; (void)b; (void)pos; (void)outbuff;
+    return TF_Send(dst, msg);
+#else
+    // The received checksum is valid only for the received payload, while it's dispatched
+    if (msg->len == 0 || msg->data != TF_RX_PAYLOAD(src) || msg->len != src->len || src->lst_busy == 0) {
+        return TF_Send(dst, msg);
+    }
+
+    TF_TRY(TF_ClaimTx(dst));
+
+    pos = TF_ComposeHead(dst, outbuff, msg);
+    if (pos + msg->len + sizeof(TF_CKSUM) <= TF_SENDBUF_LEN) {
+        // Small frame - join it in the Tx buffer and write it at once
+        memcpy(outbuff + pos, msg->data, msg->len);
+        pos += msg->len;
+    } else {
+        TF_WriteImpl(dst, outbuff, pos);
+        TF_WriteImpl(dst, msg->data, msg->len);
+        pos = 0;
+    }
+
+    // The payload checksum, as received (it was checked to match the payload)
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+    WRITENUM(TF_CKSUM, src->ref_cksum);
+#endif
+    TF_WriteImpl(dst, outbuff, pos);
+
+    TF_ReleaseTx(dst);
+    return true;
+#endif
+}
+
 //endregion Sending API funcs
 
 
@@ -1054,9 +2265,234 @@ void _TF_FN TF_Multipart_Close(TinyFrame *tf)
     TF_SendFrame_End(tf);
 }
 
+uint8_t * _TF_FN TF_Multipart_Buffer(TinyFrame *tf, uint32_t needed, uint32_t *avail)
+{
+    if (needed > TF_SENDBUF_LEN) {
+        TF_Error("Multipart write of %d bytes won't fit in the Tx buffer", (int)needed);
+        *avail = 0;
+        return NULL;
+    }
+
+    // Flush if the requested space isn't available
+    if (TF_SENDBUF_LEN - tf->tx_pos < needed) {
+        TF_SendFrame_Flush(tf);
+    }
+
+    *avail = TF_SENDBUF_LEN - tf->tx_pos;
+    return tf->sendbuf + tf->tx_pos;
+}
+
+void _TF_FN TF_Multipart_Commit(TinyFrame *tf, uint32_t length)
+{
+    CKSUM_ADD_BLOCK(tf->tx_cksum, tf->sendbuf + tf->tx_pos, length);
+    tf->tx_pos += length;
+
+    // Flush if the buffer is full
+    if (tf->tx_pos == TF_SENDBUF_LEN) {
+        TF_SendFrame_Flush(tf);
+    }
+}
+
+bool _TF_FN TF_Multipart_SetLength(TinyFrame *tf, TF_LEN len)
+{
+    int8_t si = 0; // signed small int
+    uint8_t b = 0;
+    uint8_t *outbuff = tf->sendbuf;
+    uint32_t pos = 0;
+    TF_CKSUM cksum = 0;
+
+    (void)cksum; // suppress "unused" warning if checksums are disabled
+
+    if (tf->tx_flushed) {
+        TF_Error("Can't change multipart length, the head was already sent");
+        return false;
+    }
+
+    // LEN follows the SOF byte, address and ID
+    pos = TF_HEAD_ID_POS + sizeof(TF_ID);
+    WRITENUM(TF_LEN, len);
+
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+    // Re-calculate the head checksum
+    pos += sizeof(TF_TYPE);
+    CKSUM_RESET(cksum);
+    CKSUM_ADD_BLOCK(cksum, outbuff, pos);
+    CKSUM_FINALIZE(cksum);
+    WRITENUM(TF_CKSUM, cksum);
+#endif
+
+    tf->tx_len = len;
+    return true;
+}
+
+void _TF_FN TF_Multipart_Abort(TinyFrame *tf)
+{
+    tf->tx_pos = 0;
+    TF_ReleaseTx(tf);
+}
+
 //endregion Sending API funcs - multipart
 
 
+//region Prepared frames
+
+/** Compose a frame into a buffer */
+bool _TF_FN TF_Prepare(TF_PreparedFrame *pf, uint8_t *buf, uint32_t size, const TF_Msg *msg)
+{
+    TF_Msg m = *msg;
+    TF_CKSUM cksum = 0;
+    uint32_t pos;
+
+    if (size < TF_HEAD_LEN + msg->len + ((msg->len > 0) ? TF_CKSUM_LEN : 0)
+        || (msg->data == NULL && msg->len > 0)) {
+        TF_Error("Can't prepare frame of %d bytes", (int)msg->len);
+        return false;
+    }
+
+    m.is_response = true; // keep the ID, the instance isn't needed then
+    pos = TF_ComposeHead(NULL, buf, &m);
+    pf->head_len = pos;
+
+    if (m.len > 0) {
+        CKSUM_RESET(cksum);
+        pos += TF_ComposeBody(buf + pos, m.data, m.len, &cksum);
+        pos += TF_ComposeTail(buf + pos, &cksum);
+    }
+
+    pf->frame = buf;
+    pf->len = pos;
+    return true;
+}
+
+/** Send a prepared frame */
+bool _TF_FN TF_SendPrepared(TinyFrame *tf, const TF_PreparedFrame *pf, bool new_id)
+{
+    uint8_t head[TF_HEAD_LEN];
+    TF_ID id;
+    TF_CKSUM cksum = 0;
+    uint32_t pos;
+    uint8_t *outbuff = head;
+    int8_t si = 0; // signed small int
+    uint8_t b = 0;
+
+    (void)cksum; (void)si; (void)b; // unused if checksums are disabled
+
+    TF_TRY(TF_ClaimTx(tf));
+
+#if TF_USE_PULL_TX
+    if (tf->tx_pending) {
+        TF_ReleaseTx(tf);
+        return false;
+    }
+#endif
+
+    if (!new_id) {
+#if TF_USE_PULL_TX
+        tf->tx_pos = 0;
+        TF_SendFrame_Queue(tf, pf->frame, pf->len, false);
+#else
+        TF_WriteImpl(tf, pf->frame, pf->len);
+#endif
+        TF_ReleaseTx(tf);
+        return true;
+    }
+
+    id = (TF_ID) (tf->next_id++ & TF_ID_MASK);
+    if (tf->peer_bit) {
+        id |= TF_ID_PEERBIT;
+    }
+
+    // Patch the ID in a copy of the header and checksum it again
+    memcpy(head, pf->frame, pf->head_len);
+    pos = TF_HEAD_ID_POS;
+    WRITENUM(TF_ID, id);
+
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+    CKSUM_RESET(cksum);
+    CKSUM_ADD_BLOCK(cksum, head, pf->head_len - sizeof(TF_CKSUM));
+    CKSUM_FINALIZE(cksum);
+    pos = pf->head_len - sizeof(TF_CKSUM);
+    WRITENUM(TF_CKSUM, cksum);
+#endif
+
+#if TF_USE_PULL_TX
+    memcpy(tf->sendbuf, head, pf->head_len);
+    tf->tx_pos = pf->head_len;
+    TF_SendFrame_Queue(tf, pf->frame + pf->head_len, pf->len - pf->head_len, false);
+#else
+    TF_WriteImpl(tf, head, pf->head_len);
+    if (pf->len > pf->head_len) {
+        TF_WriteImpl(tf, pf->frame + pf->head_len, pf->len - pf->head_len);
+    }
+#endif
+    TF_ReleaseTx(tf);
+    return true;
+}
+
+//endregion Prepared frames
+
+
+#if TF_USE_PULL_TX
+//region Pull Tx
+
+/** Pull bytes of the frame waiting to be sent */
+uint32_t _TF_FN TF_PollTx(TinyFrame *tf, uint8_t *buf, uint32_t max)
+{
+    uint32_t n = 0;
+    uint32_t chunk;
+
+    if (!tf->tx_pending) return 0;
+    TF_Barrier(); // see the frame as it was queued
+
+    while (n < max) {
+        if (tf->tx_out < tf->tx_pos) {
+            // Staged bytes (the head, multipart payload, checksum)
+            chunk = TF_MIN(max - n, tf->tx_pos - tf->tx_out);
+            memcpy(buf + n, tf->sendbuf + tf->tx_out, chunk);
+            tf->tx_out += chunk;
+            n += chunk;
+        }
+        else if (tf->tx_data_len > 0) {
+            // Payload from the caller's buffer, composed right into the driver's buffer
+            chunk = TF_MIN(max - n, tf->tx_data_len);
+            if (tf->tx_data_cksum) {
+                TF_ComposeBody(buf + n, tf->tx_data, (TF_LEN) chunk, &tf->tx_cksum);
+            } else {
+                memcpy(buf + n, tf->tx_data, chunk);
+            }
+            tf->tx_data += chunk;
+            tf->tx_data_len -= chunk;
+            n += chunk;
+
+            if (tf->tx_data_len == 0 && tf->tx_data_cksum) {
+                // The checksum follows
+                tf->tx_out = 0;
+                tf->tx_pos = TF_ComposeTail(tf->sendbuf, &tf->tx_cksum);
+            }
+        }
+        else {
+            break;
+        }
+    }
+
+    if (tf->tx_out == tf->tx_pos && tf->tx_data_len == 0) {
+        // All pulled, the next frame can be sent
+        TF_Barrier();
+        tf->tx_pending = false;
+    }
+    return n;
+}
+
+/** Check if a frame waits to be pulled */
+bool _TF_FN TF_TxPending(TinyFrame *tf)
+{
+    return tf->tx_pending;
+}
+
+//endregion Pull Tx
+#endif
+
+
 /** Timebase hook - for timeouts */
 void _TF_FN TF_Tick(TinyFrame *tf)
 {
@@ -1069,6 +2505,7 @@ void _TF_FN TF_Tick(TinyFrame *tf)
     }
 
     // decrement and expire ID listeners
+    tf->lst_busy++;
     for (i = 0; i < tf->count_id_lst; i++) {
         lst = &tf->id_listeners[i];
         if (!lst->fn || lst->timeout == 0) continue;
@@ -1077,9 +2514,16 @@ void _TF_FN TF_Tick(TinyFrame *tf)
             TF_Error("ID listener %d has expired", (int)lst->id);
             if (lst->fn_timeout != NULL) {
                 lst->fn_timeout(tf); // execute timeout function
+                lst = &tf->id_listeners[i];
             }
             // Listener has expired
-            cleanup_id_listener(tf, i, lst);
+            cleanup_id_listener(tf, lst);
         }
     }
+    tf->lst_busy--;
+    settle_listeners(tf);
+
+#if TF_USE_DYNAMIC_LST
+    shrink_listener_tables(tf);
+#endif
 }
@@ -66,6 +66,23 @@
 #endif
 
 
+#if !defined(TF_ADDR_BYTES) || TF_ADDR_BYTES == 0
+    // no address field
+#elif TF_ADDR_BYTES == 1
+    typedef uint8_t TF_ADDR;
+#elif TF_ADDR_BYTES == 2
+    typedef uint16_t TF_ADDR;
+#elif TF_ADDR_BYTES == 4
+    typedef uint32_t TF_ADDR;
+#else
+    #error Bad value of TF_ADDR_BYTES, must be 0, 1, 2 or 4
+#endif
+
+#if TF_ADDR_BYTES && !defined(TF_ADDR_BROADCAST)
+    #define TF_ADDR_BROADCAST ((TF_ADDR) ~(TF_ADDR) 0)
+#endif
+
+
 #if (TF_CKSUM_TYPE == TF_CKSUM_XOR) || (TF_CKSUM_TYPE == TF_CKSUM_NONE) || (TF_CKSUM_TYPE == TF_CKSUM_CUSTOM8) || (TF_CKSUM_TYPE == TF_CKSUM_CRC8)
     // ~XOR (if 0, still use 1 byte - it won't be used)
     typedef uint8_t TF_CKSUM;
@@ -79,6 +96,14 @@
     #error Bad value for TF_CKSUM_TYPE
 #endif
 
+#if TF_MAX_RANGE_LST > 32
+    #error TF_MAX_RANGE_LST can be at most 32
+#endif
+
+#if TF_RX_RING_LEN & (TF_RX_RING_LEN - 1)
+    #error TF_RX_RING_LEN must be a power of two
+#endif
+
 //endregion
 
 //---------------------------------------------------------------------------
@@ -104,6 +129,9 @@ typedef struct TF_Msg_ {
     TF_ID frame_id;       //!< message ID
     bool is_response;     //!< internal flag, set when using the Respond function. frame_id is then kept unchanged.
     TF_TYPE type;         //!< received or sent message type
+#if TF_ADDR_BYTES
+    TF_ADDR addr;         //!< destination address (own or TF_ADDR_BROADCAST when received - set it before responding)
+#endif
 
     /**
      * Buffer of received data, or data to send.
@@ -181,6 +209,8 @@ TinyFrame *TF_Init(TF_Peer peer_bit);
  * Initialize the TinyFrame engine using a statically allocated instance struct.
  *
  * The .userdata / .usertag field is preserved when TF_InitStatic is called.
+ * With TF_USE_DYNAMIC_LST, calling it again on an initialized instance releases
+ * its listener tables.
  *
  * @param tf - instance
  * @param peer_bit - peer bit to use for self
@@ -190,11 +220,21 @@ bool TF_InitStatic(TinyFrame *tf, TF_Peer peer_bit);
 
 /**
  * De-init the dynamically allocated TF instance
+ * (also releasing the listener tables if TF_USE_DYNAMIC_LST is enabled)
  *
  * @param tf - instance
  */
 void TF_DeInit(TinyFrame *tf);
 
+/**
+ * De-init a statically allocated TF instance - release the listener tables
+ * if TF_USE_DYNAMIC_LST is enabled, the struct itself is kept.
+ * The instance must be initialized again before it's used.
+ *
+ * @param tf - instance
+ */
+void TF_DeInitStatic(TinyFrame *tf);
+
 
 // ---------------------------------- API CALLS --------------------------------------
 
@@ -276,6 +316,55 @@ bool TF_AddTypeListener(TinyFrame *tf, TF_TYPE frame_type, TF_Listener cb);
  */
 bool TF_RemoveTypeListener(TinyFrame *tf, TF_TYPE type);
 
+#if TF_MAX_RANGE_LST
+
+/**
+ * Register a listener for a range of frame types.
+ *
+ * Range and mask listeners are tried after the type listeners, in the order they were added.
+ * The lookup structure is rebuilt when adding or removing them, so dispatching a frame
+ * takes a binary search, regardless of the number of listeners.
+ *
+ * @param tf - instance
+ * @param first - first type of the range
+ * @param last - last type of the range (inclusive)
+ * @param cb - callback
+ * @return success
+ */
+bool TF_AddTypeRangeListener(TinyFrame *tf, TF_TYPE first, TF_TYPE last, TF_Listener cb);
+
+/**
+ * Register a listener for frame types matching a mask, i.e. (type & mask) == value.
+ * See TF_AddTypeRangeListener().
+ *
+ * @param tf - instance
+ * @param value - value of the masked bits
+ * @param mask - bits to compare
+ * @param cb - callback
+ * @return success
+ */
+bool TF_AddTypeMaskListener(TinyFrame *tf, TF_TYPE value, TF_TYPE mask, TF_Listener cb);
+
+/**
+ * Remove a range listener.
+ *
+ * @param tf - instance
+ * @param first - first type of the range
+ * @param last - last type of the range
+ */
+bool TF_RemoveTypeRangeListener(TinyFrame *tf, TF_TYPE first, TF_TYPE last);
+
+/**
+ * Remove a mask listener.
+ *
+ * @param tf - instance
+ * @param value - value of the masked bits
+ * @param mask - bits to compare
+ */
+bool TF_RemoveTypeMaskListener(TinyFrame *tf, TF_TYPE value, TF_TYPE mask);
+
+#endif
+
 /**
  * Register a generic listener.
  *
@@ -314,6 +403,21 @@ bool TF_RenewIdListener(TinyFrame *tf, TF_ID id);
  */
 bool TF_Send(TinyFrame *tf, TF_Msg *msg);
 
+/**
+ * Like TF_Send, but with TF_USE_PULL_TX the payload is not copied to the Tx buffer;
+ * it's read from msg->data while the frame is pulled, so it can be longer than
+ * TF_SENDBUF_LEN. The buffer must stay valid and unchanged until the frame is pulled
+ * (see TF_TxPending()) - don't use a stack buffer.
+ *
+ * Without TF_USE_PULL_TX, this is the same as TF_Send().
+ * Set msg->is_response (and msg->frame_id) to send a response.
+ *
+ * @param tf - instance
+ * @param msg - message struct. ID is stored in the frame_id field
+ * @return success
+ */
+bool TF_Send_NoCopy(TinyFrame *tf, TF_Msg *msg);
+
 /**
  * Like TF_Send, but without the struct
  */
@@ -342,12 +446,34 @@ bool TF_QuerySimple(TinyFrame *tf, TF_TYPE type,
 /**
  * Send a response to a received message.
  *
+ * With TF_ADDR_BYTES, the frame goes to msg->addr, which in a received message is the own
+ * (or the broadcast) address - frames don't carry the sender's address. Set msg->addr
+ * to the address of the peer before responding (e.g. the master's); a response to the own
+ * or the broadcast address is refused.
+ *
  * @param tf - instance
  * @param msg - message struct. ID is read from frame_id. set ->renew to reset listener timeout
  * @return success
  */
 bool TF_Respond(TinyFrame *tf, TF_Msg *msg);
 
+/**
+ * Forward a received frame through another instance (e.g. from a gateway's listener).
+ *
+ * If the payload is the received one (msg->data and msg->len unchanged), it's written
+ * out straight from the Rx buffer and the received payload checksum is reused,
+ * so only the header is composed. Otherwise this works like TF_Send().
+ *
+ * Set msg->is_response to keep msg->frame_id, otherwise a new ID is assigned by dst
+ * (and stored in msg->frame_id).
+ *
+ * @param dst - instance to send the frame with
+ * @param src - instance that received the frame, must be called from its listener
+ * @param msg - the received message, can have a different ID, type or address
+ * @return success
+ */
+bool TF_Forward(TinyFrame *dst, TinyFrame *src, TF_Msg *msg);
+
 
 // ------------------------ MULTIPART FRAME TX FUNCTIONS -----------------------------
 // Those routines are used to send long frames without having all the data available
@@ -398,6 +524,325 @@ void TF_Multipart_Payload(TinyFrame *tf, const uint8_t *buff, uint32_t length);
  */
 void TF_Multipart_Close(TinyFrame *tf);
 
+/**
+ * Get a pointer to the free space in the Tx buffer, so the payload of a started multipart
+ * frame can be written into it directly, without an intermediate buffer.
+ * The written bytes are then added to the frame using TF_Multipart_Commit().
+ *
+ * @param tf - instance
+ * @param needed - number of bytes needed; the buffer is flushed first if less space is left
+ * @param avail - here the number of free bytes is stored
+ * @return pointer to the free space, NULL if 'needed' is larger than TF_SENDBUF_LEN
+ */
+uint8_t *TF_Multipart_Buffer(TinyFrame *tf, uint32_t needed, uint32_t *avail);
+
+/**
+ * Commit bytes written to the Tx buffer obtained from TF_Multipart_Buffer().
+ * They are added to the checksum, and the buffer is flushed if it became full.
+ *
+ * @param tf - instance
+ * @param length - number of bytes written
+ */
+void TF_Multipart_Commit(TinyFrame *tf, uint32_t length);
+
+/**
+ * Change the payload length of a started multipart frame (back-patch the LEN field).
+ * This is possible only until the head is flushed, i.e. while the frame fits in the Tx buffer.
+ *
+ * @param tf - instance
+ * @param len - new payload length
+ * @return success
+ */
+bool TF_Multipart_SetLength(TinyFrame *tf, TF_LEN len);
+
+/**
+ * Abandon a started multipart frame and release the Tx lock.
+ * Nothing is sent if the frame wasn't flushed yet; otherwise the peer receives
+ * a truncated frame and discards it when its parser times out.
+ *
+ * @param tf - instance
+ */
+void TF_Multipart_Abort(TinyFrame *tf);
+
+
+// ------------------------------ PREPARED FRAMES ----------------------------------
+// A frame that's sent many times (e.g. a periodic status, or a broadcast to many
+// connections) can be composed once, and then written out without building the
+// payload and computing its checksum again.
+
+/** A composed frame, see TF_Prepare() */
+typedef struct TF_PreparedFrame_ {
+    const uint8_t *frame; //!< The frame bytes
+    uint32_t len;         //!< Frame length
+    uint32_t head_len;    //!< Header length, including the header checksum
+} TF_PreparedFrame;
+
+/**
+ * Compose a frame into a buffer. The buffer must stay valid (and unchanged)
+ * while the prepared frame is used; it can be shared by many instances.
+ *
+ * The frame gets the ID msg->frame_id, TF_SendPrepared() can give it a new one.
+ *
+ * @param pf - prepared frame to initialize
+ * @param buf - buffer for the frame
+ * @param size - buffer size, at least the payload length + header and checksums
+ * @param msg - message to compose, msg->data must hold the whole payload
+ * @return success (false if the buffer is too small)
+ */
+bool TF_Prepare(TF_PreparedFrame *pf, uint8_t *buf, uint32_t size, const TF_Msg *msg);
+
+/**
+ * Send a prepared frame.
+ *
+ * With new_id, the frame is sent with the next ID of the instance (as TF_Send() would),
+ * only the ID and the header checksum are patched in a copy of the header.
+ * Otherwise the frame is written as it is, in one call to TF_WriteImpl().
+ *
+ * @param tf - instance
+ * @param pf - the frame
+ * @param new_id - give the frame a new ID
+ * @return success
+ */
+bool TF_SendPrepared(TinyFrame *tf, const TF_PreparedFrame *pf, bool new_id);
+
+
+// ------------------------------ RX RING ----------------------------------
+// With TF_RX_RING_LEN, an interrupt handler (or a reader thread, DMA callback etc.)
+// can push the received bytes to a ring buffer, and the main loop parses them
+// by calling TF_Process(). The ring is lock-free, with a single producer and
+// a single consumer (TF_Process()).
+
+#if TF_RX_RING_LEN
+
+/**
+ * Push a received byte to the Rx ring. Safe to call from an interrupt.
+ *
+ * @param tf - instance
+ * @param c - the byte
+ * @return false if the ring is full (the byte is dropped)
+ */
+bool TF_RxPush(TinyFrame *tf, uint8_t c);
+
+/**
+ * Push received bytes to the Rx ring. Safe to call from an interrupt.
+ *
+ * @param tf - instance
+ * @param buffer - the bytes
+ * @param count - number of bytes
+ * @return number of bytes pushed, the rest didn't fit and was dropped
+ */
+uint32_t TF_RxPushBuf(TinyFrame *tf, const uint8_t *buffer, uint32_t count);
+
+/**
+ * Parse the bytes waiting in the Rx ring (as TF_Accept() would).
+ * Call this from the main loop, the listeners run here.
+ *
+ * @param tf - instance
+ * @return number of bytes parsed
+ */
+uint32_t TF_Process(TinyFrame *tf);
+
+#endif
+
+
+// ------------------------------ PULL TX ----------------------------------
+// With TF_USE_PULL_TX, the frames aren't written out by TF_WriteImpl(). The driver pulls
+// them with TF_PollTx() when it's ready to send (e.g. a UART DMA transfer completed or
+// a socket is writable), and the frame is composed right into the driver's buffer.
+//
+// One frame can wait to be pulled at a time; sending fails until it's all pulled
+// (see TF_TxPending()). TF_Send(), TF_Respond() etc. copy the frame to the Tx buffer
+// (TF_SENDBUF_LEN), and fail if it doesn't fit. A longer payload can be sent with
+// TF_Send_NoCopy(), which reads it from the caller's buffer while pulling, so it must
+// stay valid until then. Multipart frames are staged in the Tx buffer, and must fit in it.
+//
+// TF_PollTx() can run in an interrupt, but not at the same time with another
+// TF_PollTx() on the same instance.
+
+#if TF_USE_PULL_TX
+
+/**
+ * Pull bytes of the frame waiting to be sent.
+ *
+ * @param tf - instance
+ * @param buf - buffer to store the bytes in
+ * @param max - max number of bytes to pull
+ * @return number of bytes stored, 0 if nothing is waiting
+ */
+uint32_t TF_PollTx(TinyFrame *tf, uint8_t *buf, uint32_t max);
+
+/**
+ * Check if a frame waits to be pulled.
+ *
+ * @param tf - instance
+ * @return true if a frame waits, a new one can't be sent then
+ */
+bool TF_TxPending(TinyFrame *tf);
+
+#endif
+
+
+// ------------------------------ ADDRESSING ----------------------------------
+// On a multi-drop bus (e.g. RS-485), the frames carry a destination address.
+// Frames for other nodes are skipped after the header, without buffering or
+// checksumming the payload. Enable by setting TF_ADDR_BYTES in the config file.
+
+#if TF_ADDR_BYTES
+
+/**
+ * Set the own address. Frames addressed to it or to TF_ADDR_BROADCAST are received.
+ * An instance with the address TF_ADDR_BROADCAST receives all frames (e.g. a bus monitor).
+ * The address is 0 after init.
+ *
+ * Sent frames go to msg->addr (0 after TF_ClearMsg()). When responding, set it to
+ * the address of the peer, the received msg->addr is the own or the broadcast address.
+ *
+ * @param tf - instance
+ * @param addr - own address
+ */
+void TF_SetAddress(TinyFrame *tf, TF_ADDR addr);
+
+#endif
+
+
+// ------------------------------ RX FILTER ----------------------------------
+// Those routines let the parser decide whether a frame is wanted as soon as its header
+// is received. The payload of an unwanted frame is then only counted, not buffered
+// or checksummed - useful on links where most of the traffic is for someone else.
+// Enable by setting TF_USE_RX_FILTER to 1 in the config file.
+
+#if TF_USE_RX_FILTER
+
+/**
+ * Rx filter - decide whether to receive a frame.
+ * It's called when a frame header was received and verified, before the payload.
+ * msg->data is NULL and msg->len is the full payload length.
+ *
+ * @param tf - instance
+ * @param msg - the frame's header
+ * @return true to receive the frame, false to skip it
+ */
+typedef bool (*TF_RxFilter)(TinyFrame *tf, TF_Msg *msg);
+
+/**
+ * Set the Rx filter.
+ *
+ * @param tf - instance
+ * @param cb - filter, NULL to receive all frames; use TF_HasListener to skip frames
+ *             no listener would handle
+ */
+void TF_SetRxFilter(TinyFrame *tf, TF_RxFilter cb);
+
+/**
+ * Check if a frame would be handled by a listener (or the stream listener).
+ * Can be used as the Rx filter, or called from a custom one.
+ *
+ * @param tf - instance
+ * @param msg - the frame's header
+ * @return true if there's an ID, Type, range or Generic listener that may handle it
+ */
+bool TF_HasListener(TinyFrame *tf, TF_Msg *msg);
+
+/**
+ * Set the longest payload accepted for a frame type. Longer frames of the type
+ * are skipped after the header, and reported by TF_Error().
+ *
+ * @param tf - instance
+ * @param frame_type - type of a registered Type listener
+ * @param max_len - max payload length, 0 = no limit
+ * @return true if the listener was found
+ */
+bool TF_SetTypeMaxLen(TinyFrame *tf, TF_TYPE frame_type, TF_LEN max_len);
+
+#endif
+
+
+// ------------------------------ RX DESTINATION ----------------------------------
+// This lets the application receive the payload of a frame straight into its own buffer
+// (e.g. a DMA-able region or a record slot), instead of copying it out of tf->data.
+// Enable by setting TF_USE_RX_DEST to 1 in the config file.
+
+#if TF_USE_RX_DEST
+
+/**
+ * Rx destination callback - choose where to store the payload of a frame.
+ * It's called when a frame header was received and verified, before the payload.
+ * msg->data is NULL and msg->len is the full payload length.
+ *
+ * The returned buffer must have room for msg->len bytes; it's then passed to the
+ * listeners as msg->data. The frame may be larger than TF_MAX_PAYLOAD_RX.
+ * Note that the buffer is written even if the frame later fails the checksum check,
+ * its content is valid only if a listener gets the frame.
+ *
+ * @param tf - instance
+ * @param msg - the frame's header
+ * @return buffer to store the payload in, NULL to use tf->data
+ */
+typedef uint8_t *(*TF_RxDest)(TinyFrame *tf, TF_Msg *msg);
+
+/**
+ * Set the Rx destination callback.
+ *
+ * @param tf - instance
+ * @param cb - callback, NULL to always use tf->data
+ */
+void TF_SetRxDest(TinyFrame *tf, TF_RxDest cb);
+
+#endif
+
+
+// ------------------------------ STREAMING RX ----------------------------------
+// Those routines let a listener handle the payload while it's still being received,
+// instead of waiting for the whole frame to be buffered in tf->data.
+// This also allows receiving frames larger than TF_MAX_PAYLOAD_RX.
+// Enable by setting TF_USE_STREAM_RX to 1 in the config file.
+
+#if TF_USE_STREAM_RX
+
+/**
+ * Stream read function - pull more bytes of the incoming byte stream.
+ * Typically this waits for data from the UART (with a timeout).
+ *
+ * @param tf - instance
+ * @param buf - buffer to store the bytes in
+ * @param max - max number of bytes to read (never more than what's left of the payload)
+ * @return number of bytes read, 0 on error or timeout
+ */
+typedef uint32_t (*TF_StreamRead)(TinyFrame *tf, uint8_t *buf, uint32_t max);
+
+/**
+ * Set the stream listener. It's called when a frame header was received and verified,
+ * before the payload. msg->data is NULL and msg->len is the full payload length.
+ *
+ * The listener reads the payload using TF_StreamChunk(). Payload it leaves unread is
+ * skipped by the parser. If TF_NEXT is returned and no payload was read, the frame
+ * is received and dispatched normally. TF_CLOSE removes the stream listener.
+ *
+ * Note that the body checksum can be verified only after the listener returns,
+ * a mismatch is then reported by TF_Error().
+ *
+ * @param tf - instance
+ * @param cb - listener, NULL to remove it
+ * @param read - read function used when the bytes given to TF_Accept() run out (can be NULL)
+ */
+void TF_SetStreamListener(TinyFrame *tf, TF_Listener cb, TF_StreamRead read);
+
+/**
+ * Get the next chunk of the payload of a frame being streamed.
+ * Can only be called from the stream listener.
+ *
+ * The chunk is taken from the rest of the buffer given to TF_Accept(), or read
+ * into tf->data using the stream read function. It's valid until the next call.
+ *
+ * @param tf - instance
+ * @param max - max number of bytes to get
+ * @param len - here the chunk length is stored
+ * @return pointer to the chunk, NULL if the payload was all read or the read failed
+ */
+const uint8_t *TF_StreamChunk(TinyFrame *tf, uint32_t max, uint32_t *len);
+
+#endif
+
 
 // ---------------------------------- INTERNAL ----------------------------------
 // This is publicly visible only to allow static init.
@@ -409,7 +854,10 @@ enum TF_State_ {
     TFState_ID,           //!< Wait for ID
     TFState_TYPE,         //!< Wait for message type
     TFState_DATA,         //!< Receive payload
-    TFState_DATA_CKSUM    //!< Wait for Checksum
+    TFState_DATA_CKSUM,   //!< Wait for Checksum
+#if TF_ADDR_BYTES
+    TFState_ADDR,         //!< Wait for destination address
+#endif
 };
 
 struct TF_IdListener_ {
@@ -425,12 +873,23 @@ struct TF_IdListener_ {
 struct TF_TypeListener_ {
     TF_TYPE type;
     TF_Listener fn;
+#if TF_USE_RX_FILTER
+    TF_LEN max_len; //!< Longest payload accepted, 0 = no limit
+#endif
 };
 
 struct TF_GenericListener_ {
     TF_Listener fn;
 };
 
+struct TF_TypeRangeListener_ {
+    TF_TYPE first;  // type range
+    TF_TYPE last;
+    TF_TYPE mask;   // within the range, only types with (type & mask) == value match
+    TF_TYPE value;
+    TF_Listener fn;
+};
+
 /**
  * Frame parser internal state.
  */
@@ -455,7 +914,40 @@ struct TinyFrame_ {
     TF_CKSUM cksum;         //!< Checksum calculated of the data stream
     TF_CKSUM ref_cksum;     //!< Reference checksum read from the message
     TF_TYPE type;           //!< Collected message type number
-    bool discard_data;      //!< Set if (len > TF_MAX_PAYLOAD) to read the frame, but ignore the data.
+#if TF_ADDR_BYTES
+    TF_ADDR addr;           //!< Own address
+    TF_ADDR rx_addr;        //!< Collected destination address
+#endif
+    bool discard_data;      //!< Set if (len > TF_MAX_PAYLOAD) or the frame was filtered out, to read the frame, but ignore the data.
+
+#if TF_USE_RX_FILTER
+    TF_RxFilter rx_filter;  //!< Header filter, called before the payload is received
+#endif
+
+#if TF_RX_RING_LEN
+    /* Rx ring - indices run freely, the ring position is the index modulo its size */
+    uint8_t rx_ring[TF_RX_RING_LEN]; //!< Received bytes waiting for TF_Process()
+    volatile uint32_t rx_ring_head;  //!< Written by the producer
+    volatile uint32_t rx_ring_tail;  //!< Written by TF_Process()
+#endif
+
+#if TF_USE_RX_DEST
+    TF_RxDest rx_dest_fn;   //!< Callback choosing where to store the payload
+    uint8_t *rx_dest;       //!< Where the payload of the frame is stored (tf->data, or the chosen buffer)
+#endif
+
+#if TF_USE_FAST_PARSER
+    const uint8_t *rx_inplace; //!< Payload read in place from the TF_Accept() buffer, NULL if it was stored
+#endif
+
+#if TF_USE_STREAM_RX
+    /* Streaming Rx */
+    TF_Listener stream_lst;       //!< Stream listener, called before the payload is received
+    TF_StreamRead stream_read;    //!< Read function used to pull more payload for the stream listener
+    const uint8_t *stream_buf;    //!< Unprocessed part of the buffer passed to TF_Accept()
+    uint32_t stream_buf_len;      //!< Number of bytes left in stream_buf
+    bool streaming;               //!< Set if the payload is handled by the stream listener
+#endif
 
     /* Tx state */
     // Buffer for building frames
@@ -464,6 +956,17 @@ struct TinyFrame_ {
     uint32_t tx_pos;        //!< Next write position in the Tx buffer (used for multipart)
     uint32_t tx_len;        //!< Total expected Tx length
     TF_CKSUM tx_cksum;      //!< Transmit checksum accumulator
+    bool tx_flushed;        //!< Set when a part of the current frame was written out (the head can't be patched)
+
+#if TF_USE_PULL_TX
+    /* Pull Tx - the frame waiting to be pulled is the rest of sendbuf, then tx_data */
+    uint32_t tx_out;        //!< Next byte of sendbuf to pull
+    const uint8_t *tx_data; //!< Payload sent from the caller's buffer
+    uint32_t tx_data_len;   //!< Number of bytes left in tx_data
+    bool tx_data_cksum;     //!< Set if tx_data is checksummed and followed by the checksum
+    bool tx_broken;         //!< Set if a multipart frame didn't fit in sendbuf
+    volatile bool tx_pending; //!< Set while a frame waits to be pulled
+#endif
 
 #if !TF_USE_MUTEX
     bool soft_lock;         //!< Tx lock flag used if the mutex feature is not enabled.
@@ -472,16 +975,42 @@ struct TinyFrame_ {
     /* --- Callbacks --- */
 
     /* Transaction callbacks */
+#if TF_USE_DYNAMIC_LST
+    // The tables are allocated on demand and grow up to TF_MAX_*_LST slots
+    struct TF_IdListener_ *id_listeners;
+    struct TF_TypeListener_ *type_listeners;
+    struct TF_GenericListener_ *generic_listeners;
+
+    // Number of allocated slots
+    TF_COUNT cap_id_lst;
+    TF_COUNT cap_type_lst;
+    TF_COUNT cap_generic_lst;
+
+    struct TinyFrame_ *lst_owner; //!< The instance itself once initialized - the table pointers are valid then
+#else
     struct TF_IdListener_ id_listeners[TF_MAX_ID_LST];
     struct TF_TypeListener_ type_listeners[TF_MAX_TYPE_LST];
     struct TF_GenericListener_ generic_listeners[TF_MAX_GEN_LST];
+#endif
 
-    // Those counters are used to optimize look-up times.
-    // They point to the highest used slot number,
-    // or close to it, depending on the removal order.
+    // Number of listeners in the tables. The live listeners are kept at the start
+    // of each table, so the loops don't visit free slots and adding is O(1).
     TF_COUNT count_id_lst;
     TF_COUNT count_type_lst;
     TF_COUNT count_generic_lst;
+
+#if TF_MAX_RANGE_LST
+    // Range and mask listeners, and their lookup structure: the type space split into
+    // segments (sorted by the first type), each with a bitmap of the listeners matching it
+    struct TF_TypeRangeListener_ range_listeners[TF_MAX_RANGE_LST];
+    TF_TYPE range_seg_start[TF_MAX_RANGE_LST * 2 + 1];
+    uint32_t range_seg_lst[TF_MAX_RANGE_LST * 2 + 1];
+    TF_COUNT count_range_lst;
+    TF_COUNT count_range_seg;
+#endif
+
+    TF_COUNT lst_busy;      //!< Nesting depth of loops over the tables (removed listeners are only marked meanwhile)
+    bool lst_dirty;         //!< Set if the tables contain marked listeners to be dropped
 };
 
 
@@ -490,7 +1019,7 @@ struct TinyFrame_ {
 /**
  * 'Write bytes' function that sends data to UART
  *
- * ! Implement this in your application code !
+ * ! Implement this in your application code ! (not used with TF_USE_PULL_TX)
  */
 extern void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len);
 
@@ -524,6 +1053,20 @@ extern void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len);
      */
     extern TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte);
 
+#if TF_USE_CKSUM_BLOCK
+    /**
+     * Update a checksum with a block of bytes (if TF_USE_CKSUM_BLOCK is enabled).
+     * Used for the payload and other contiguous spans, instead of TF_CksumAdd() per byte.
+     * Must give the same result as TF_CksumAdd() called for each byte.
+     *
+     * @param cksum - previous checksum value
+     * @param buf - bytes to add
+     * @param len - number of bytes
+     * @return updated checksum value
+     */
+    extern TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len);
+#endif
+
     /**
      * Finalize the checksum calculation
      *
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+#define FRAME_COUNT 50
+#define FRAME_LEN 200
+#define ROUNDS 200
+
+static TinyFrame sender, receiver;
+
+static uint8_t wire[FRAME_COUNT * (FRAME_LEN + 16)];
+static uint32_t wire_len;
+
+static int received = 0;
+static bool content_ok = true;
+
+// How the checksum was computed
+static uint32_t byte_calls = 0;
+static uint32_t block_bytes = 0;
+
+// CRC32 tables for slicing-by-4
+static uint32_t crc_table[4][256];
+
+static void crc_init(void)
+{
+    uint32_t i, j, c;
+
+    for (i = 0; i < 256; i++) {
+        c = i;
+        for (j = 0; j < 8; j++) {
+            c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+        }
+        crc_table[0][i] = c;
+    }
+    for (i = 0; i < 256; i++) {
+        for (j = 1; j < 4; j++) {
+            c = crc_table[j - 1][i];
+            crc_table[j][i] = (c >> 8) ^ crc_table[0][c & 0xFF];
+        }
+    }
+}
+
+TF_CKSUM TF_CksumStart(void)
+{
+    return 0xFFFFFFFF;
+}
+
+TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte)
+{
+    byte_calls++;
+    return crc_table[0][(cksum ^ byte) & 0xFF] ^ (cksum >> 8);
+}
+
+/** The same CRC, four bytes per step */
+TF_CKSUM TF_CksumAddBlock(TF_CKSUM cksum, const uint8_t *buf, uint32_t len)
+{
+    block_bytes += len;
+    while (len >= 4) {
+        cksum ^= (uint32_t) buf[0] | ((uint32_t) buf[1] << 8) | ((uint32_t) buf[2] << 16) | ((uint32_t) buf[3] << 24);
+        cksum = crc_table[3][cksum & 0xFF] ^ crc_table[2][(cksum >> 8) & 0xFF]
+                ^ crc_table[1][(cksum >> 16) & 0xFF] ^ crc_table[0][cksum >> 24];
+        buf += 4;
+        len -= 4;
+    }
+    while (len-- > 0) {
+        cksum = crc_table[0][(cksum ^ *buf++) & 0xFF] ^ (cksum >> 8);
+    }
+    return cksum;
+}
+
+TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
+{
+    return ~cksum;
+}
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(wire + wire_len, buff, len);
+    wire_len += len;
+}
+
+/** The payload is the frame number, repeated */
+TF_Result frameListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint32_t i;
+    for (i = 0; i < msg->len; i++) {
+        if (msg->data[i] != (uint8_t) (received + msg->type)) content_ok = false;
+    }
+    received++;
+    return TF_STAY;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void main(void)
+{
+    uint8_t payload[FRAME_LEN];
+    uint32_t i, n, crc_bytes, crc_block;
+    TF_Msg msg;
+    double t;
+
+    crc_init();
+    TF_InitStatic(&sender, TF_MASTER);
+    TF_InitStatic(&receiver, TF_SLAVE);
+    TF_AddGenericListener(&receiver, frameListener);
+
+    printf("------ Same CRC --------\n");
+
+    for (i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t) (i * 7 + 3);
+    crc_bytes = TF_CksumStart();
+    for (i = 0; i < 103; i++) crc_bytes = TF_CksumAdd(crc_bytes, payload[i]);
+    crc_block = TF_CksumAddBlock(TF_CksumStart(), payload, 103);
+    printf(crc_bytes == crc_block ? "Slicing OK\n" : "Slicing FAIL\n");
+
+    printf("------ Payload in blocks --------\n");
+
+    byte_calls = 0;
+    block_bytes = 0;
+    for (i = 0; i < FRAME_COUNT; i++) {
+        memset(payload, (uint8_t) (i + 0x20), FRAME_LEN);
+        TF_SendSimple(&sender, 0x20, payload, FRAME_LEN);
+    }
+    TF_Accept(&receiver, wire, wire_len);
+
+    // Tx and Rx of the payload go through the block function, the headers mostly byte by byte
+    printf("%d frames, %d bytes in blocks, %d bytes one by one\n", received, block_bytes, byte_calls);
+    printf(received == FRAME_COUNT && content_ok && block_bytes >= 2 * FRAME_COUNT * (FRAME_LEN - 1)
+           && byte_calls < block_bytes / 10 ? "Block OK\n" : "Block FAIL\n");
+
+    printf("------ Multipart --------\n");
+
+    wire_len = 0;
+    received = 0;
+    TF_ClearMsg(&msg);
+    msg.type = 0x30;
+    msg.len = FRAME_LEN;
+    memset(payload, 0x30, FRAME_LEN);
+    TF_Send_Multipart(&sender, &msg);
+    for (i = 0; i < FRAME_LEN; i += n) {
+        n = (FRAME_LEN - i < 37) ? FRAME_LEN - i : 37;
+        TF_Multipart_Payload(&sender, payload + i, n);
+    }
+    TF_Multipart_Close(&sender);
+
+    // corrupted copy after it
+    memcpy(wire + wire_len, wire, wire_len);
+    wire[wire_len + 30] ^= 1;
+    wire_len *= 2;
+
+    TF_Accept(&receiver, wire, wire_len);
+    printf(received == 1 && content_ok ? "Multipart OK\n" : "Multipart FAIL\n");
+
+    printf("------ Speed --------\n");
+
+    wire_len = 0;
+    for (i = 0; i < FRAME_COUNT; i++) {
+        TF_SendSimple(&sender, 0x20, payload, FRAME_LEN);
+    }
+
+    t = now();
+    for (n = 0; n < ROUNDS; n++) {
+        for (i = 0; i < wire_len; i++) {
+            TF_AcceptChar(&receiver, wire[i]);
+        }
+    }
+    t = now() - t;
+    printf("%-28s %8.1f MB/s\n", "TF_AcceptChar(), per byte", (double) wire_len * ROUNDS / t / 1e6);
+
+    t = now();
+    for (n = 0; n < ROUNDS; n++) {
+        TF_Accept(&receiver, wire, wire_len);
+    }
+    t = now() - t;
+    printf("%-28s %8.1f MB/s\n", "TF_Accept(), in blocks", (double) wire_len * ROUNDS / t / 1e6);
+}
@@ -0,0 +1,37 @@
+//
+// Config for the dynamic listener tables demo
+//
+
+#ifndef TF_CONFIG_H
+#define TF_CONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+
+#define TF_ID_BYTES     1
+#define TF_LEN_BYTES    2
+#define TF_TYPE_BYTES   1
+#define TF_CKSUM_TYPE TF_CKSUM_CRC16
+#define TF_USE_SOF_BYTE 1
+#define TF_SOF_BYTE     0x01
+typedef uint16_t TF_TICKS;
+typedef uint8_t TF_COUNT;
+#define TF_MAX_PAYLOAD_RX 64
+#define TF_SENDBUF_LEN 64
+#define TF_MAX_ID_LST   200
+#define TF_MAX_TYPE_LST 10
+#define TF_MAX_GEN_LST  5
+#define TF_PARSER_TIMEOUT_TICKS 10
+
+#define TF_USE_DYNAMIC_LST 1
+
+// Count the table allocations
+void *demo_realloc(void *ptr, size_t size);
+void demo_free(void *ptr);
+#define TF_Realloc(ptr, size) demo_realloc(ptr, size)
+#define TF_Free(ptr) demo_free(ptr)
+
+#define TF_Error(format, ...) printf("[TF] " format "\n", ##__VA_ARGS__)
+
+#endif //TF_CONFIG_H
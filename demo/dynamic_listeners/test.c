@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+TinyFrame *demo_tf;
+
+#define QUERY_COUNT 100
+
+// Sent frames are kept here and received later
+static uint8_t wire[QUERY_COUNT * 16];
+static uint32_t wire_len;
+
+static int allocs = 0;
+static int live_tables = 0;
+static int responses = 0;
+
+void *demo_realloc(void *ptr, size_t size)
+{
+    allocs++;
+    if (ptr == NULL) live_tables++;
+    return realloc(ptr, size);
+}
+
+void demo_free(void *ptr)
+{
+    if (ptr != NULL) live_tables--;
+    free(ptr);
+}
+
+TF_Result anyListener(TinyFrame *tf, TF_Msg *msg)
+{
+    return TF_STAY;
+}
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(wire + wire_len, buff, len);
+    wire_len += len;
+}
+
+/** ID listener of the queries - the frames come back as the responses */
+TF_Result replyListener(TinyFrame *tf, TF_Msg *msg)
+{
+    responses++;
+    return TF_CLOSE;
+}
+
+void main(void)
+{
+    int i;
+    bool good = true;
+
+    demo_tf = TF_Init(TF_MASTER);
+
+    printf("------ Burst of queries --------\n");
+
+    for (i = 0; i < QUERY_COUNT; i++) {
+        if (!TF_QuerySimple(demo_tf, 0x22, (pu8) "?", 1, replyListener, NULL, 10)) good = false;
+    }
+    printf("%d ID listeners, table size %d, %d allocations\n",
+           (int)demo_tf->count_id_lst, (int)demo_tf->cap_id_lst, allocs);
+    if (demo_tf->count_id_lst != QUERY_COUNT || demo_tf->cap_id_lst < QUERY_COUNT) good = false;
+    printf(good ? "Burst OK\n" : "Burst FAIL\n");
+
+    printf("------ Responses --------\n");
+
+    TF_Accept(demo_tf, wire, wire_len);
+    printf("%d responses, %d listeners left\n", responses, (int)demo_tf->count_id_lst);
+    printf(responses == QUERY_COUNT && demo_tf->count_id_lst == 0 ? "Responses OK\n" : "Responses FAIL\n");
+
+    printf("------ Idle --------\n");
+
+    for (i = 0; i < 10; i++) {
+        TF_Tick(demo_tf);
+    }
+    printf("Table size %d\n", (int)demo_tf->cap_id_lst);
+    printf(demo_tf->cap_id_lst <= 4 ? "Shrunk OK\n" : "Shrunk FAIL\n");
+
+    TF_DeInit(demo_tf);
+    printf(live_tables == 0 ? "DeInit OK\n" : "DeInit FAIL\n");
+
+    printf("------ Static instance --------\n");
+
+    // Init, add listeners, deinit - the tables must not leak
+    static TinyFrame stf;
+    for (i = 0; i < 50; i++) {
+        TF_InitStatic(&stf, TF_SLAVE);
+        TF_AddTypeListener(&stf, 0x10, anyListener);
+        TF_AddGenericListener(&stf, anyListener);
+        TF_QuerySimple(&stf, 0x22, (pu8) "?", 1, replyListener, NULL, 10);
+        if (i % 2 == 0) {
+            TF_DeInitStatic(&stf);
+        }
+        // odd rounds rely on the next TF_InitStatic() releasing them
+    }
+    TF_DeInitStatic(&stf);
+    printf("%d tables left\n", live_tables);
+    printf(live_tables == 0 ? "Static OK\n" : "Static FAIL\n");
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+// Benchmark of the listener tables after heavy churn of ID listeners
+
+TinyFrame *demo_tf; // receiver
+TinyFrame *tx_tf;   // used to compose the frames
+
+#define LISTENERS 1000
+#define KEEP 50
+#define ROUNDS 100000
+
+// Composed frames, one per ID
+static uint8_t frames[KEEP][16];
+static uint32_t frame_len[KEEP];
+static uint8_t *capture;
+static uint32_t capture_len;
+
+static uint32_t hits = 0;
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(capture + capture_len, buff, len);
+    capture_len += len;
+}
+
+TF_Result idListener(TinyFrame *tf, TF_Msg *msg)
+{
+    hits++;
+    return TF_STAY;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void addListener(TF_ID id)
+{
+    TF_Msg msg;
+    TF_ClearMsg(&msg);
+    msg.frame_id = id;
+    TF_AddIdListener(demo_tf, &msg, idListener, NULL, 0);
+}
+
+void main(void)
+{
+    static TF_ID ids[LISTENERS];
+    TF_Msg msg;
+    uint32_t i, j, r;
+    double t;
+
+    demo_tf = TF_Init(TF_MASTER);
+    tx_tf = TF_Init(TF_SLAVE);
+    srand(1234);
+
+    printf("------ Churn --------\n");
+
+    // Add many listeners, then remove most of them in random order
+    for (i = 0; i < LISTENERS; i++) {
+        ids[i] = (TF_ID) (i + 1);
+        addListener(ids[i]);
+    }
+    for (i = LISTENERS - 1; i > 0; i--) {
+        r = (uint32_t) rand() % (i + 1);
+        TF_ID tmp = ids[i];
+        ids[i] = ids[r];
+        ids[r] = tmp;
+    }
+    for (i = KEEP; i < LISTENERS; i++) {
+        TF_RemoveIdListener(demo_tf, ids[i]);
+    }
+
+    printf("%d listeners scanned by the loops, %d live\n", (int)demo_tf->count_id_lst, KEEP);
+    printf(demo_tf->count_id_lst == KEEP ? "Compaction OK\n" : "Compaction FAIL\n");
+
+    // Compose frames for the remaining listeners
+    for (i = 0; i < KEEP; i++) {
+        capture = frames[i];
+        capture_len = 0;
+        TF_ClearMsg(&msg);
+        msg.frame_id = ids[i];
+        msg.type = 0x33;
+        msg.data = (pu8) "x";
+        msg.len = 1;
+        TF_Respond(tx_tf, &msg);
+        frame_len[i] = capture_len;
+    }
+
+    printf("------ Benchmark --------\n");
+
+    t = now();
+    for (i = 0; i < ROUNDS; i++) {
+        j = i % KEEP;
+        TF_Accept(demo_tf, frames[j], frame_len[j]);
+    }
+    t = now() - t;
+    printf("Dispatch: %.1f ns per frame\n", t / ROUNDS);
+    printf(hits == ROUNDS ? "Dispatch OK\n" : "Dispatch FAIL\n");
+
+    t = now();
+    for (i = 0; i < ROUNDS; i++) {
+        TF_Tick(demo_tf);
+    }
+    t = now() - t;
+    printf("Tick: %.1f ns\n", t / ROUNDS);
+
+    t = now();
+    for (i = 0; i < ROUNDS; i++) {
+        addListener(2000);
+        TF_RemoveIdListener(demo_tf, 2000);
+    }
+    t = now() - t;
+    printf("Add + remove: %.1f ns\n", t / ROUNDS);
+    printf(demo_tf->count_id_lst == KEEP ? "Churn OK\n" : "Churn FAIL\n");
+}
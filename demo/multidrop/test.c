@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+#define NODE_COUNT 4
+
+// Nodes on the bus: the master (0), two slaves (1, 2) and a bus monitor
+static TinyFrame nodes[NODE_COUNT];
+static int received[NODE_COUNT];
+static int refused;
+
+#define MASTER (&nodes[0])
+#define MASTER_ADDR 0
+#define MONITOR (&nodes[3])
+
+// The bus - everything written is seen by all the nodes
+static uint8_t bus[256];
+static uint32_t bus_len;
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(bus + bus_len, buff, len);
+    bus_len += len;
+}
+
+/** Deliver the bus traffic to all the nodes, until it's quiet */
+static void run_bus(void)
+{
+    uint8_t traffic[sizeof(bus)];
+    uint32_t len;
+    int i;
+
+    while (bus_len > 0) {
+        len = bus_len;
+        memcpy(traffic, bus, len);
+        bus_len = 0;
+        for (i = 0; i < NODE_COUNT; i++) {
+            TF_Accept(&nodes[i], traffic, len);
+        }
+    }
+}
+
+/** Slaves answer the commands to the master */
+TF_Result commandListener(TinyFrame *tf, TF_Msg *msg)
+{
+    received[tf - nodes]++;
+    if (msg->addr == TF_ADDR_BROADCAST) {
+        return TF_STAY; // not answered
+    }
+
+    msg->data = (pu8) "ack";
+    msg->len = 3;
+
+    // msg->addr is still the own address, the response would go nowhere
+    if (!TF_Respond(tf, msg)) refused++;
+
+    msg->addr = MASTER_ADDR;
+    TF_Respond(tf, msg);
+    return TF_STAY;
+}
+
+/** The master gets the answer */
+TF_Result ackListener(TinyFrame *tf, TF_Msg *msg)
+{
+    received[tf - nodes]++;
+    return TF_CLOSE;
+}
+
+/** The monitor sees everything */
+TF_Result monitorListener(TinyFrame *tf, TF_Msg *msg)
+{
+    received[tf - nodes]++;
+    return TF_STAY;
+}
+
+/** Check the counts of frames received by the nodes */
+static bool expect(int master, int slave1, int slave2, int monitor)
+{
+    bool ok = received[0] == master && received[1] == slave1 && received[2] == slave2 && received[3] == monitor;
+    if (!ok) {
+        printf("Received %d %d %d %d, expected %d %d %d %d\n",
+               received[0], received[1], received[2], received[3], master, slave1, slave2, monitor);
+    }
+    memset(received, 0, sizeof(received));
+    return ok;
+}
+
+void main(void)
+{
+    TF_Msg msg;
+    bool good;
+    int i;
+
+    for (i = 0; i < NODE_COUNT; i++) {
+        TF_InitStatic(&nodes[i], i == 0 ? TF_MASTER : TF_SLAVE);
+        TF_SetAddress(&nodes[i], (TF_ADDR) (MASTER_ADDR + i));
+        if (i == 1 || i == 2) {
+            TF_AddTypeListener(&nodes[i], 0x10, commandListener);
+        }
+    }
+    TF_SetAddress(MONITOR, TF_ADDR_BROADCAST);
+    TF_AddGenericListener(MONITOR, monitorListener);
+
+    printf("------ Addressed query --------\n");
+
+    TF_ClearMsg(&msg);
+    msg.addr = 2;
+    msg.type = 0x10;
+    msg.data = (pu8) "status?";
+    msg.len = 7;
+    TF_Query(MASTER, &msg, ackListener, NULL, 0);
+    run_bus();
+    // slave 2 got the query, the master got the answer, the monitor saw both
+    good = expect(1, 0, 1, 2);
+    printf(good ? "Addressed OK\n" : "Addressed FAIL\n");
+    printf(refused == 1 ? "Own address refused OK\n" : "Own address refused FAIL\n");
+
+    printf("------ Broadcast --------\n");
+
+    msg.addr = TF_ADDR_BROADCAST;
+    msg.is_response = false;
+    TF_Send(MASTER, &msg);
+    run_bus();
+    good = expect(0, 1, 1, 1);
+    printf(good ? "Broadcast OK\n" : "Broadcast FAIL\n");
+
+    printf("------ Nobody --------\n");
+
+    msg.addr = 9;
+    TF_Send(MASTER, &msg);
+    run_bus();
+    good = expect(0, 0, 0, 1);
+    printf(good ? "Unknown address OK\n" : "Unknown address FAIL\n");
+}
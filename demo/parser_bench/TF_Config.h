@@ -0,0 +1,32 @@
+//
+// Config for the parser benchmark
+//
+
+#ifndef TF_CONFIG_H
+#define TF_CONFIG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define TF_ID_BYTES     2
+#define TF_LEN_BYTES    2
+#define TF_TYPE_BYTES   1
+#define TF_CKSUM_TYPE TF_CKSUM_CRC16
+#define TF_USE_SOF_BYTE 1
+#define TF_SOF_BYTE     0x01
+typedef uint16_t TF_TICKS;
+typedef uint8_t TF_COUNT;
+#define TF_MAX_PAYLOAD_RX 256
+#define TF_SENDBUF_LEN 300
+#define TF_MAX_ID_LST   5
+#define TF_MAX_TYPE_LST 10
+#define TF_MAX_GEN_LST  5
+#define TF_PARSER_TIMEOUT_TICKS 10
+
+#define TF_USE_FAST_PARSER 1
+
+// The corrupted frames are counted, not printed
+extern int tf_errors;
+#define TF_Error(format, ...) (tf_errors++)
+
+#endif //TF_CONFIG_H
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+#define FRAME_COUNT 3000
+#define ROUNDS 20
+
+int tf_errors = 0;
+
+static TinyFrame sender, receiver;
+
+// The traffic: frames of various lengths, noise between them, some corrupted
+static uint8_t wire[FRAME_COUNT * 300];
+static uint32_t wire_len;
+static int corrupted;
+
+// What the receiver got
+static int received;
+static uint32_t digest;
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(wire + wire_len, buff, len);
+    wire_len += len;
+}
+
+/** Count the frames and hash their content, to compare the runs */
+TF_Result benchListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint32_t i;
+    digest = (digest ^ msg->type ^ msg->len) * 16777619;
+    for (i = 0; i < msg->len; i++) {
+        digest = (digest ^ msg->data[i]) * 16777619;
+    }
+    received++;
+    return TF_STAY;
+}
+
+static void reset(void)
+{
+    TF_ResetParser(&receiver);
+    received = 0;
+    digest = 2166136261;
+    tf_errors = 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, double t)
+{
+    printf("%-22s %8.1f MB/s %8.2f Mframes/s\n", name,
+           (double) wire_len * ROUNDS / t / 1e6, (double) FRAME_COUNT * ROUNDS / t / 1e6);
+}
+
+/**
+ * Fill the wire with frames of the given lengths, in turn.
+ * On a noisy line, there's garbage between the frames, full of false SOFs.
+ */
+static void build_wire(const uint16_t *lengths, uint32_t count, bool noisy)
+{
+    static uint32_t seed = 1;
+    uint8_t payload[256];
+    uint32_t i, n, pos;
+
+    wire_len = 0;
+    corrupted = 0;
+    for (i = 0; i < FRAME_COUNT; i++) {
+        n = lengths[i % count];
+        for (pos = 0; pos < n; pos++) {
+            seed = seed * 1103515245 + 12345;
+            payload[pos] = (uint8_t) (seed >> 16);
+        }
+        TF_SendSimple(&sender, (TF_TYPE) (0x10 + i % 7), payload, n);
+
+        if (i % 50 == 25 && n > 0) {
+            wire[wire_len - 3] ^= 0x40; // in the payload
+            corrupted++;
+        }
+        if (noisy) {
+            seed = seed * 1103515245 + 12345;
+            for (n = (seed >> 16) % 24; n > 0; n--) {
+                seed = seed * 1103515245 + 12345;
+                wire[wire_len++] = ((seed >> 16) & 7) == 0 ? TF_SOF_BYTE : (uint8_t) (seed >> 20);
+            }
+        } else if (i % 10 == 3) {
+            memset(wire + wire_len, 0xEE, 5); // line noise
+            wire_len += 5;
+        }
+    }
+
+    printf("%d frames, %d bytes, %d corrupted\n", FRAME_COUNT, (int) wire_len, corrupted);
+}
+
+/**
+ * Check the buffer and byte-wise parsers give the same frames, then time them.
+ * On a noisy line, the buffer parser must get all the good frames - the byte-wise one
+ * loses those starting inside a false header.
+ */
+static void run(const char *name, bool noisy)
+{
+    uint32_t i, n, pos, seed = 7;
+    int ref_received, ref_errors;
+    uint32_t ref_digest;
+    double t;
+
+    // The byte-wise parser
+    reset();
+    for (i = 0; i < wire_len; i++) {
+        TF_AcceptChar(&receiver, wire[i]);
+    }
+    ref_received = received;
+    ref_errors = tf_errors;
+    ref_digest = digest;
+    if (noisy) {
+        printf("%s reference: %d of %d good frames\n", name, received, FRAME_COUNT - corrupted);
+    } else {
+        printf(received == FRAME_COUNT - corrupted && tf_errors == corrupted
+               ? "%s reference OK\n" : "%s reference FAIL\n", name);
+    }
+
+    // The whole buffer at once
+    reset();
+    TF_Accept(&receiver, wire, wire_len);
+    if (noisy) {
+        printf("%s bulk: %d of %d good frames\n", name, received, FRAME_COUNT - corrupted);
+        printf(received == FRAME_COUNT - corrupted ? "%s resync OK\n" : "%s resync FAIL\n", name);
+    } else {
+        printf(received == ref_received && digest == ref_digest && tf_errors == ref_errors
+               ? "%s bulk OK\n" : "%s bulk FAIL\n", name);
+
+        // Split anywhere, e.g. inside the header fields
+        reset();
+        for (pos = 0; pos < wire_len; pos += n) {
+            seed = seed * 1103515245 + 12345;
+            n = 1 + (seed >> 16) % 37;
+            if (n > wire_len - pos) n = wire_len - pos;
+            TF_Accept(&receiver, wire + pos, n);
+        }
+        printf(received == ref_received && digest == ref_digest && tf_errors == ref_errors
+               ? "%s chunks OK\n" : "%s chunks FAIL\n", name);
+    }
+
+    t = now();
+    for (n = 0; n < ROUNDS; n++) {
+        for (i = 0; i < wire_len; i++) {
+            TF_AcceptChar(&receiver, wire[i]);
+        }
+    }
+    report("TF_AcceptChar()", now() - t);
+
+    t = now();
+    for (n = 0; n < ROUNDS; n++) {
+        for (i = 0; i < wire_len; i++) {
+            TF_Accept(&receiver, wire + i, 1);
+        }
+    }
+    report("TF_Accept(), 1 B", now() - t);
+
+    t = now();
+    for (n = 0; n < ROUNDS; n++) {
+        for (pos = 0; pos < wire_len; pos += 64) {
+            TF_Accept(&receiver, wire + pos, wire_len - pos < 64 ? wire_len - pos : 64);
+        }
+    }
+    report("TF_Accept(), 64 B", now() - t);
+
+    t = now();
+    for (n = 0; n < ROUNDS; n++) {
+        TF_Accept(&receiver, wire, wire_len);
+    }
+    report("TF_Accept(), all", now() - t);
+}
+
+void main(void)
+{
+    static const uint16_t mixed[] = {0, 4, 8, 17, 64, 240};
+    static const uint16_t small[] = {0, 1, 2, 4, 6, 8};
+
+    TF_InitStatic(&sender, TF_MASTER);
+    TF_InitStatic(&receiver, TF_SLAVE);
+    TF_AddGenericListener(&receiver, benchListener);
+
+    printf("------ Mixed frames --------\n");
+    build_wire(mixed, 6, false);
+    run("Mixed", false);
+
+    // Mostly header, the payload loop hardly matters
+    printf("------ Small frames --------\n");
+    build_wire(small, 6, false);
+    run("Small", false);
+
+    printf("------ Noisy line --------\n");
+    build_wire(small, 6, true);
+    run("Noisy", true);
+}
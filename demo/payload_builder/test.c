@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+#include "tf_payload.h"
+#include "payload_scatter.h"
+
+TinyFrame *demo_tf;
+
+#define SAMPLE_COUNT 50
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    printf("\033[32mTF_WriteImpl - sending %d bytes\033[0m\n", (int)len);
+
+    // Send it back as if we received it
+    TF_Accept(tf, buff, len);
+}
+
+/** Check the samples frame */
+TF_Result samplesListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint32_t i;
+    bool good = true;
+    PayloadParser pp = pp_start(msg->data, msg->len, NULL);
+
+    dumpFrameInfo(msg);
+
+    if (pp_u16(&pp) != SAMPLE_COUNT) good = false;
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        if (pp_u32(&pp) != i * 1000) good = false;
+    }
+    if (!pp.ok || pp_length(&pp) != 0) good = false;
+
+    printf(good ? "Samples frame OK\n" : "Samples frame FAIL\n");
+    return TF_STAY;
+}
+
+/** Check the status frame */
+TF_Result statusListener(TinyFrame *tf, TF_Msg *msg)
+{
+    char name[16];
+    PayloadParser pp = pp_start_be(msg->data, msg->len, NULL);
+
+    dumpFrameInfo(msg);
+
+    bool good = (msg->len == 9 + 16 + 1 + 2 + 1 + 10);
+    if (pp_u8(&pp) != 0xA5) good = false;
+    if (pp_i16(&pp) != -1234) good = false;
+    pp_string(&pp, name, sizeof(name));
+    if (strcmp(name, "node1") != 0) good = false;
+    if (pp_u64(&pp) != 1518000000123ULL) good = false;
+    if (pp_double(&pp) != -3.25) good = false;
+    if (pp_varint(&pp) != 5) good = false;
+    if (pp_varint(&pp) != 300) good = false;
+    if (pp_svarint(&pp) != -5) good = false;
+    if (pp_varint(&pp) != UINT64_MAX) good = false;
+    if (!pp.ok || pp_length(&pp) != 0) good = false;
+
+    printf(good ? "Status frame OK\n" : "Status frame FAIL\n");
+    return TF_STAY;
+}
+
+/** Check the arrays frame */
+TF_Result arraysListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint16_t words[SAMPLE_COUNT];
+    float floats[SAMPLE_COUNT];
+    uint32_t i;
+    bool good = true;
+    PayloadParser pp = pp_start_be(msg->data, msg->len, NULL);
+
+    dumpFrameInfo(msg);
+
+    if (msg->data[0] != 0x00 || msg->data[1] != 0x00 || msg->data[2] != 0x00 || msg->data[3] != 0x07) good = false;
+    if (!pp_u16_array(&pp, words, SAMPLE_COUNT)) good = false;
+    pp.bigendian = false;
+    if (!pp_float_array(&pp, floats, SAMPLE_COUNT)) good = false;
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        if (words[i] != i * 7) good = false;
+        if (floats[i] != i * 0.5f) good = false;
+    }
+    if (pp_length(&pp) != 0) good = false;
+
+    // reading past the end must fail
+    if (pp_u16_array(&pp, words, 1) || pp.ok) good = false;
+
+    printf(good ? "Arrays frame OK\n" : "Arrays frame FAIL\n");
+    return TF_STAY;
+}
+
+/** Check the frame built in the arena */
+TF_Result arenaListener(TinyFrame *tf, TF_Msg *msg)
+{
+    char name[32];
+    uint32_t i;
+    bool good = true;
+    PayloadParser pp = pp_start(msg->data, msg->len, NULL);
+
+    dumpFrameInfo(msg);
+
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        if (pp_u32(&pp) != i * 3) good = false;
+    }
+    pp_string(&pp, name, sizeof(name));
+    if (strcmp(name, "spans several arena chunks") != 0) good = false;
+    if (!pp.ok || pp_length(&pp) != 0) good = false;
+
+    printf(good ? "Arena frame OK\n" : "Arena frame FAIL\n");
+    return TF_STAY;
+}
+
+static int length_frames = 0;
+static bool length_good = false;
+
+/** Check the frame cut at the announced length */
+TF_Result lengthListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint32_t i;
+    PayloadParser pp = pp_start(msg->data, msg->len, NULL);
+
+    dumpFrameInfo(msg);
+
+    length_frames++;
+    length_good = (msg->len == 100);
+    for (i = 0; i < 25; i++) {
+        if (pp_u32(&pp) != i) length_good = false;
+    }
+    if (!pp.ok || pp_length(&pp) != 0) length_good = false;
+    return TF_STAY;
+}
+
+// Arena for the variable-size frames, growing with malloc if needed
+static uint8_t arena_mem[128];
+static PayloadArena arena;
+static int arena_allocs = 0;
+
+static void *arenaAlloc(uint32_t size)
+{
+    arena_allocs++;
+    return malloc(size);
+}
+
+/** Build and send a payload in the arena */
+static bool sendFromArena(void)
+{
+    TF_Msg msg;
+    PayloadChain chain;
+    PayloadBuilder *pb;
+    uint32_t i;
+    bool ok;
+
+    pb = pa_start(&chain, &arena, false);
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        pb_u32(pb, i * 3);
+    }
+    pb_string(pb, "spans several arena chunks");
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x14;
+    ok = TF_Send_Chain(demo_tf, &msg, &chain);
+    pa_release(&chain);
+    return ok;
+}
+
+/** Full handler that claims success, but makes no room */
+static bool stuckHandler(PayloadBuilder *pb, uint32_t needed)
+{
+    return true;
+}
+
+/** A handler making no progress must not hang the builder */
+static void writeStuck(void)
+{
+    uint8_t buf[4];
+    PayloadBuilder pb = pb_start(buf, sizeof(buf), stuckHandler);
+
+    if (!pb_string(&pb, "does not fit") && !pb.ok && pb_length(&pb) == 4) {
+        printf("Stuck handler OK\n");
+    } else {
+        printf("Stuck handler FAIL\n");
+    }
+}
+
+/** Parse a payload split into several segments */
+static void parseScatter(void)
+{
+    // a ring buffer that wrapped around, and the values are split at odd places
+    static const uint8_t part1[] = {0x34, 0x12, 0x78, 0x56, 0x34};
+    static const uint8_t part2[] = {0x12, 'a', 'b'};
+    static const uint8_t part3[] = {'c', 0, 0xAC};
+    static const uint8_t part4[] = {0x02, 0xFF, 0xFF, 0xFF, 0xFF};
+    pp_iovec iov[] = {
+        {part1, sizeof(part1)},
+        {NULL, 0},
+        {part2, sizeof(part2)},
+        {part3, sizeof(part3)},
+        {part4, sizeof(part4)},
+    };
+    PayloadScatter ps;
+    PayloadParser *pp = pp_start_scatter(&ps, iov, 5, false);
+    char str[8];
+    bool good = true;
+
+    if (pp_scatter_remaining(&ps) != 16) good = false;
+    if (pp_u16(pp) != 0x1234) good = false;
+    if (pp_u32(pp) != 0x12345678) good = false;
+    pp_string(pp, str, sizeof(str));
+    if (strcmp(str, "abc") != 0) good = false;
+    if (pp_varint(pp) != 300) good = false;
+    if (pp_scatter_remaining(&ps) != 4) good = false;
+    if (pp_i32(pp) != -1) good = false;
+    if (!pp->ok || pp_scatter_remaining(&ps) != 0) good = false;
+
+    // no more data
+    pp_u8(pp);
+    if (pp->ok) good = false;
+
+    printf(good ? "Scatter parse OK\n" : "Scatter parse FAIL\n");
+}
+
+void main(void)
+{
+    TF_Msg msg;
+    PayloadBuilder pb;
+    uint32_t i;
+
+    demo_tf = TF_Init(TF_MASTER);
+    TF_AddTypeListener(demo_tf, 0x10, samplesListener);
+    TF_AddTypeListener(demo_tf, 0x11, statusListener);
+    TF_AddTypeListener(demo_tf, 0x13, arraysListener);
+    TF_AddTypeListener(demo_tf, 0x14, arenaListener);
+    TF_AddTypeListener(demo_tf, 0x15, lengthListener);
+
+    printf("------ Payload larger than the Tx buffer, known length --------\n");
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x10;
+    msg.len = 2 + SAMPLE_COUNT * 4;
+    TF_Send_Builder(demo_tf, &msg, &pb, false);
+    pb_u16(&pb, SAMPLE_COUNT);
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        pb_u32(&pb, i * 1000);
+    }
+    if (!TF_Builder_Close(demo_tf, &pb)) printf("Send FAIL\n");
+
+    printf("------ Short payload, length filled in when closing --------\n");
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x11;
+    TF_Send_Builder(demo_tf, &msg, &pb, true);
+    pb_u8(&pb, 0xA5);
+    pb_i16(&pb, -1234);
+    pb_string(&pb, "node1");
+    pb_u64(&pb, 1518000000123ULL);
+    pb_double(&pb, -3.25);
+    pb_varint(&pb, 5);
+    pb_varint(&pb, 300);
+    pb_svarint(&pb, -5);
+    pb_varint(&pb, UINT64_MAX);
+    if (!TF_Builder_Close(demo_tf, &pb)) printf("Send FAIL\n");
+
+    printf("------ Arrays written in bulk, across Tx buffer flushes --------\n");
+
+    uint16_t words[SAMPLE_COUNT];
+    float floats[SAMPLE_COUNT];
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        words[i] = (uint16_t) (i * 7);
+        floats[i] = i * 0.5f;
+    }
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x13;
+    msg.len = SAMPLE_COUNT * 6;
+    TF_Send_Builder(demo_tf, &msg, &pb, true);
+    pb_u16_array(&pb, words, SAMPLE_COUNT);
+    pb.bigendian = false;
+    pb_float_array(&pb, floats, SAMPLE_COUNT);
+    if (!TF_Builder_Close(demo_tf, &pb)) printf("Send FAIL\n");
+
+    printf("------ Built in a growing arena, sent chunk by chunk --------\n");
+
+    pa_init(&arena, arena_mem, sizeof(arena_mem), 24, arenaAlloc);
+    if (!sendFromArena()) printf("Send FAIL\n");
+    int grown = arena_allocs;
+
+    // The chunks are reused, no more allocations are needed
+    if (!sendFromArena()) printf("Send FAIL\n");
+    if (grown > 0 && arena_allocs == grown) {
+        printf("Arena reused OK\n");
+    } else {
+        printf("Arena reused FAIL\n");
+    }
+
+    // Without a memory block, all the chunks are allocated
+    pa_init(&arena, NULL, 0, 24, arenaAlloc);
+    arena_allocs = 0;
+    if (sendFromArena() && arena_allocs > 0) {
+        printf("Heap arena OK\n");
+    } else {
+        printf("Heap arena FAIL\n");
+    }
+
+    printf("------ Parsing a payload split into segments --------\n");
+
+    parseScatter();
+
+    printf("------ Full handler making no room (should fail) --------\n");
+
+    writeStuck();
+
+    printf("------ Known length, payload too long (should fail) --------\n");
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x15;
+    msg.len = 100;
+    TF_Send_Builder(demo_tf, &msg, &pb, false);
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        pb_u32(&pb, i);
+    }
+    // The head is out already, the frame is cut at the announced length
+    if (!TF_Builder_Close(demo_tf, &pb) && length_frames == 1 && length_good) {
+        printf("Long payload cut OK\n");
+    } else {
+        printf("Long payload cut FAIL\n");
+    }
+
+    printf("------ Known length, payload too short (should fail) --------\n");
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x15;
+    msg.len = 20;
+    TF_Send_Builder(demo_tf, &msg, &pb, false);
+    for (i = 0; i < 3; i++) {
+        pb_u32(&pb, i);
+    }
+    // Nothing was flushed, the frame is discarded
+    if (!TF_Builder_Close(demo_tf, &pb) && length_frames == 1) {
+        printf("Short payload rejected OK\n");
+    } else {
+        printf("Short payload rejected FAIL\n");
+    }
+
+    printf("------ Unknown length not fitting the buffer (should fail) --------\n");
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x11;
+    TF_Send_Builder(demo_tf, &msg, &pb, true);
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        pb_u32(&pb, i);
+    }
+    if (TF_Builder_Close(demo_tf, &pb)) {
+        printf("Overflow FAIL\n");
+    } else {
+        printf("Overflow rejected OK\n");
+    }
+
+    // the Tx lock must be released after the aborted frame
+    if (TF_SendSimple(demo_tf, 0x12, (pu8) "x", 1)) {
+        printf("Tx unlocked OK\n");
+    } else {
+        printf("Tx unlocked FAIL\n");
+    }
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+#define CONN_COUNT 50
+
+// Server side and client side of each connection
+static TinyFrame servers[CONN_COUNT];
+static TinyFrame clients[CONN_COUNT];
+
+// Bytes sent over each connection
+static uint8_t wire[CONN_COUNT][256];
+static uint32_t wire_len[CONN_COUNT];
+
+static int cksum_bytes = 0;
+static int received = 0;
+static TF_ID last_id;
+
+// Simple 16-bit sum, counting the bytes
+TF_CKSUM TF_CksumStart(void)
+{
+    return 0;
+}
+
+TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte)
+{
+    cksum_bytes++;
+    return (TF_CKSUM) (cksum + byte);
+}
+
+TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
+{
+    return (TF_CKSUM) ~cksum;
+}
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    int i = (int) (tf - servers);
+    memcpy(wire[i] + wire_len[i], buff, len);
+    wire_len[i] += len;
+}
+
+/** Deliver the frames to the clients */
+static void deliver(void)
+{
+    int i;
+    for (i = 0; i < CONN_COUNT; i++) {
+        TF_Accept(&clients[i], wire[i], wire_len[i]);
+        wire_len[i] = 0;
+    }
+}
+
+/** Clients receive the status */
+TF_Result statusListener(TinyFrame *tf, TF_Msg *msg)
+{
+    if (msg->len == 100 && msg->data[0] == 'S' && msg->data[99] == 'S') received++;
+    last_id = msg->frame_id;
+    return TF_STAY;
+}
+
+void main(void)
+{
+    uint8_t status[100];
+    uint8_t frame_buf[128];
+    TF_PreparedFrame pf;
+    TF_Msg msg;
+    int i, cost;
+    bool good;
+
+    for (i = 0; i < CONN_COUNT; i++) {
+        TF_InitStatic(&servers[i], TF_MASTER);
+        TF_InitStatic(&clients[i], TF_SLAVE);
+        TF_AddTypeListener(&clients[i], 0x40, statusListener);
+    }
+
+    printf("------ Prepare --------\n");
+
+    memset(status, 'S', sizeof(status));
+    TF_ClearMsg(&msg);
+    msg.type = 0x40;
+    msg.data = status;
+    msg.len = sizeof(status);
+    msg.frame_id = 7;
+
+    good = TF_Prepare(&pf, frame_buf, sizeof(frame_buf), &msg);
+    printf("Frame of %d bytes, %d bytes checksummed\n", (int)pf.len, cksum_bytes);
+    good &= !TF_Prepare(&pf, frame_buf, 50, &msg); // doesn't fit
+    good &= TF_Prepare(&pf, frame_buf, sizeof(frame_buf), &msg);
+    printf(good && pf.len == 5 + 2 + 100 + 2 ? "Prepare OK\n" : "Prepare FAIL\n");
+
+    printf("------ Fan-out --------\n");
+
+    cksum_bytes = 0;
+    for (i = 0; i < CONN_COUNT; i++) {
+        TF_SendPrepared(&servers[i], &pf, false);
+    }
+    cost = cksum_bytes;
+    deliver();
+    printf("%d clients got it, %d bytes checksummed when sending\n", received, cost);
+    printf(received == CONN_COUNT && cost == 0 && last_id == 7 ? "Fan-out OK\n" : "Fan-out FAIL\n");
+
+    printf("------ Fan-out with new IDs --------\n");
+
+    received = 0;
+    cksum_bytes = 0;
+    for (i = 0; i < CONN_COUNT; i++) {
+        TF_SendPrepared(&servers[i], &pf, true);
+        TF_SendPrepared(&servers[i], &pf, true);
+    }
+    cost = cksum_bytes;
+    deliver();
+    printf("%d frames received, %d bytes checksummed when sending (%d with TF_Send())\n",
+           received, cost, 2 * CONN_COUNT * (5 + 100));
+    // the header is checksummed again (5 bytes), the ID is the instance's next one
+    good = received == 2 * CONN_COUNT && cost == 2 * CONN_COUNT * 5;
+    good &= last_id == (TF_ID) (0x80 | 1);
+    printf(good ? "New IDs OK\n" : "New IDs FAIL\n");
+}
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+// The sender's driver pulls the frames, the receiver gets the bytes
+static TinyFrame sender, receiver;
+
+static int received = 0;
+static int writes = 0;
+
+/** Used only by the receiver (which doesn't send anything) */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    writes++;
+}
+
+/**
+ * The driver - like a DMA transfer complete interrupt, starting the next
+ * transfer of up to 16 bytes while there's something to send
+ */
+static void run_dma(void)
+{
+    uint8_t dma_buf[16];
+    uint32_t n;
+
+    while ((n = TF_PollTx(&sender, dma_buf, sizeof(dma_buf))) > 0) {
+        TF_Accept(&receiver, dma_buf, n);
+    }
+}
+
+TF_Result dataListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint32_t i;
+    for (i = 0; i < msg->len; i++) {
+        if (msg->data[i] != (uint8_t) i) return TF_STAY;
+    }
+    received++;
+    return TF_STAY;
+}
+
+void main(void)
+{
+    uint8_t payload[100];
+    uint8_t frame_buf[128];
+    TF_PreparedFrame pf;
+    TF_Msg msg;
+    uint32_t i;
+    bool good;
+
+    for (i = 0; i < sizeof(payload); i++) payload[i] = (uint8_t) i;
+
+    TF_InitStatic(&sender, TF_MASTER);
+    TF_InitStatic(&receiver, TF_SLAVE);
+    TF_AddGenericListener(&receiver, dataListener);
+
+    printf("------ Frames --------\n");
+
+    // larger than the Tx buffer, it's not copied
+    good = !TF_SendSimple(&sender, 0x10, payload, 100);
+    good &= !TF_TxPending(&sender);
+
+    // composed from the caller's buffer while pulled
+    TF_ClearMsg(&msg);
+    msg.type = 0x10;
+    msg.data = payload;
+    msg.len = 100;
+    good &= TF_Send_NoCopy(&sender, &msg);
+    good &= TF_TxPending(&sender);
+    good &= !TF_SendSimple(&sender, 0x10, payload, 10); // busy until pulled
+    run_dma();
+    good &= !TF_TxPending(&sender);
+    good &= TF_SendSimple(&sender, 0x11, NULL, 0);
+    run_dma();
+
+    // short, copied to the Tx buffer - the caller's buffer can be reused right away
+    good &= TF_SendSimple(&sender, 0x12, payload, 10);
+    payload[5] = 0xFF;
+    run_dma();
+    payload[5] = 5;
+    good &= received == 3;
+    printf(good ? "Frames OK\n" : "Frames FAIL\n");
+
+    printf("------ Multipart --------\n");
+
+    received = 0;
+    good = TF_SendSimple_Multipart(&sender, 0x12, 20);
+    TF_Multipart_Payload(&sender, payload, 10);
+    TF_Multipart_Payload(&sender, payload + 10, 10);
+    TF_Multipart_Close(&sender);
+    run_dma();
+    good &= received == 1;
+
+    // doesn't fit in the Tx buffer
+    good &= TF_SendSimple_Multipart(&sender, 0x12, 50);
+    TF_Multipart_Payload(&sender, payload, 50);
+    TF_Multipart_Close(&sender);
+    good &= !TF_TxPending(&sender);
+    run_dma();
+    good &= received == 1;
+    printf(good ? "Multipart OK\n" : "Multipart FAIL\n");
+
+    printf("------ Prepared --------\n");
+
+    received = 0;
+    TF_ClearMsg(&msg);
+    msg.type = 0x13;
+    msg.data = payload;
+    msg.len = 60;
+    TF_Prepare(&pf, frame_buf, sizeof(frame_buf), &msg);
+    good = TF_SendPrepared(&sender, &pf, false);
+    run_dma();
+    good &= TF_SendPrepared(&sender, &pf, true);
+    run_dma();
+    good &= received == 2 && writes == 0;
+    printf(good ? "Prepared OK\n" : "Prepared FAIL\n");
+}
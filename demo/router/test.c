@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+#include "frame_router.h"
+
+// A device on a serial link, and two clients on TCP connections, all behind a gateway.
+// Each link has an instance at both ends; the gateway's instances are connected by the router.
+static TinyFrame device, gw_serial;
+static TinyFrame client1, gw_tcp1;
+static TinyFrame client2, gw_tcp2;
+
+static FrameRouter router;
+
+// Bytes in flight on each link, delivered by run_links()
+typedef struct {
+    TinyFrame *to;
+    uint8_t buf[1024];
+    uint32_t len;
+} Link;
+
+static Link links[6] = {
+    {.to = &gw_serial}, {.to = &device},
+    {.to = &gw_tcp1}, {.to = &client1},
+    {.to = &gw_tcp2}, {.to = &client2},
+};
+
+static int cksum_bytes = 0;
+static int answers[2];
+static int events[2];
+static int readings;
+
+// Simple 16-bit sum, counting the bytes
+TF_CKSUM TF_CksumStart(void)
+{
+    return 0;
+}
+
+TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte)
+{
+    cksum_bytes++;
+    return (TF_CKSUM) (cksum + byte);
+}
+
+TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
+{
+    return (TF_CKSUM) ~cksum;
+}
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    Link *link = tf->userdata;
+    memcpy(link->buf + link->len, buff, len);
+    link->len += len;
+}
+
+/** Deliver the bytes on all the links, until they're quiet */
+static void run_links(void)
+{
+    uint8_t traffic[1024];
+    uint32_t len;
+    bool busy = true;
+    int i;
+
+    while (busy) {
+        busy = false;
+        for (i = 0; i < 6; i++) {
+            len = links[i].len;
+            if (len == 0) continue;
+            memcpy(traffic, links[i].buf, len);
+            links[i].len = 0;
+            TF_Accept(links[i].to, traffic, len);
+            busy = true;
+        }
+    }
+}
+
+/** The gateway forwards everything */
+TF_Result gatewayListener(TinyFrame *tf, TF_Msg *msg)
+{
+    return fr_route(&router, tf, msg);
+}
+
+/** The device answers the queries */
+TF_Result queryListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint8_t answer[100];
+    memset(answer, msg->data[0], sizeof(answer));
+
+    msg->data = answer;
+    msg->len = sizeof(answer);
+    TF_Respond(tf, msg);
+    return TF_STAY;
+}
+
+/** The device answers a subscription with several readings */
+TF_Result subscribeListener(TinyFrame *tf, TF_Msg *msg)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        msg->data = (pu8) "reading";
+        msg->len = 7;
+        TF_Respond(tf, msg);
+    }
+    return TF_STAY;
+}
+
+/** A client got a reading */
+TF_Result readingListener(TinyFrame *tf, TF_Msg *msg)
+{
+    readings++;
+    return TF_STAY;
+}
+
+/** Count the ID mappings in use */
+static int used_mappings(void)
+{
+    int i, n = 0;
+    for (i = 0; i < FR_MAX_MAPPINGS; i++) {
+        if (router.mappings[i].tf != NULL) n++;
+    }
+    return n;
+}
+
+/** A client got the answer to its query */
+TF_Result answerListener(TinyFrame *tf, TF_Msg *msg)
+{
+    int n = (tf == &client1) ? 0 : 1;
+    if (msg->len == 100 && msg->data[0] == '1' + n) answers[n]++;
+    return TF_CLOSE;
+}
+
+/** A client got an event from the device */
+TF_Result eventListener(TinyFrame *tf, TF_Msg *msg)
+{
+    events[(tf == &client1) ? 0 : 1]++;
+    return TF_STAY;
+}
+
+/** Set up an instance at the end of a link */
+static void init_node(TinyFrame *tf, TF_Peer peer, Link *link)
+{
+    TF_InitStatic(tf, peer);
+    tf->userdata = link;
+}
+
+void main(void)
+{
+    int before;
+    bool good;
+    int i;
+
+    init_node(&device, TF_SLAVE, &links[0]);
+    init_node(&gw_serial, TF_MASTER, &links[1]);
+    init_node(&client1, TF_MASTER, &links[2]);
+    init_node(&gw_tcp1, TF_SLAVE, &links[3]);
+    init_node(&client2, TF_MASTER, &links[4]);
+    init_node(&gw_tcp2, TF_SLAVE, &links[5]);
+
+    TF_AddTypeListener(&device, 0x20, queryListener);
+    TF_AddTypeListener(&device, 0x21, subscribeListener);
+    TF_AddTypeListener(&client1, 0x31, eventListener);
+    TF_AddTypeListener(&client2, 0x31, eventListener);
+
+    fr_init(&router);
+    TF_AddGenericListener(&gw_serial, gatewayListener);
+    TF_AddGenericListener(&gw_tcp1, gatewayListener);
+    TF_AddGenericListener(&gw_tcp2, gatewayListener);
+
+    // queries from the clients go to the device, events from the device to all the clients
+    fr_add_route(&router, NULL, 0x20, 0x20, &gw_serial);
+    fr_add_route_multi(&router, NULL, 0x21, 0x2F, &gw_serial, 5);
+    fr_add_route(&router, &gw_serial, 0x30, 0x3F, &gw_tcp1);
+    fr_add_route(&router, &gw_serial, 0x30, 0x3F, &gw_tcp2);
+
+    printf("------ Queries --------\n");
+
+    // both clients use the same frame ID, the router tells the answers apart
+    TF_QuerySimple(&client1, 0x20, (pu8) "1", 1, answerListener, NULL, 0);
+    TF_QuerySimple(&client2, 0x20, (pu8) "2", 1, answerListener, NULL, 0);
+    run_links();
+    printf("Answers: %d, %d\n", answers[0], answers[1]);
+    // the mappings are cleared by the answers
+    good = answers[0] == 1 && answers[1] == 1 && used_mappings() == 0;
+    printf(good ? "Queries OK\n" : "Queries FAIL\n");
+
+    printf("------ Several responses --------\n");
+
+    TF_QuerySimple(&client1, 0x21, NULL, 0, readingListener, NULL, 0);
+    run_links();
+    good = readings == 3 && used_mappings() == 1;
+    // no more readings come, the mapping expires
+    for (i = 0; i < 4; i++) fr_tick(&router);
+    good &= used_mappings() == 1;
+    fr_tick(&router);
+    good &= used_mappings() == 0;
+    printf(good ? "Subscription OK\n" : "Subscription FAIL\n");
+
+    printf("------ Events --------\n");
+
+    TF_SendSimple(&device, 0x31, (pu8) "boom", 4);
+    run_links();
+    printf("Events: %d, %d\n", events[0], events[1]);
+    good = events[0] == 1 && events[1] == 1;
+    printf(good ? "Events OK\n" : "Events FAIL\n");
+
+    printf("------ Forwarding cost --------\n");
+
+    // The device answers with 100 bytes. The payload is checksummed when it's sent
+    // and received, but not again when it's forwarded; only the 5-byte header is.
+    before = cksum_bytes;
+    TF_QuerySimple(&client1, 0x20, (pu8) "1", 1, answerListener, NULL, 0);
+    run_links();
+    printf("%d bytes checksummed\n", cksum_bytes - before);
+    // 4 headers and 3 payloads of each frame (sent, received at the gateway, forwarded, received)
+    good = answers[0] == 2 && cksum_bytes - before == (4 * 5 + 3 * 1) + (4 * 5 + 3 * 100);
+    printf(good ? "Forwarding OK\n" : "Forwarding FAIL\n");
+
+    printf("------ Disconnect --------\n");
+
+    fr_remove_instance(&router, &gw_tcp2);
+    TF_SendSimple(&device, 0x31, (pu8) "boom", 4);
+    run_links();
+    good = events[0] == 2 && events[1] == 1 && router.route_count == 3;
+    printf(good ? "Disconnect OK\n" : "Disconnect FAIL\n");
+}
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+TinyFrame *demo_tf;
+
+#define RECORD_LEN 200
+#define RECORD_COUNT 4
+
+// The records are received straight into those slots
+static uint8_t records[RECORD_COUNT][RECORD_LEN];
+static int next_record = 0;
+static int stored = 0;
+
+static bool do_corrupt = false;
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    uint8_t xbuff[TF_SENDBUF_LEN];
+    memcpy(xbuff, buff, len);
+    if (do_corrupt) {
+        xbuff[len - 1]++;
+        do_corrupt = false;
+    }
+    // send to the same instance (loopback)
+    TF_Accept(tf, xbuff, len);
+}
+
+/** Records go to the next free slot, other frames to tf->data */
+uint8_t *recordDest(TinyFrame *tf, TF_Msg *msg)
+{
+    if (msg->type != 0x10 || msg->len > RECORD_LEN) return NULL;
+    return records[next_record];
+}
+
+/** The record is already in its slot, just keep it */
+TF_Result recordListener(TinyFrame *tf, TF_Msg *msg)
+{
+    if (msg->data == records[next_record]) {
+        stored++;
+        next_record = (next_record + 1) % RECORD_COUNT;
+    }
+    return TF_STAY;
+}
+
+TF_Result otherListener(TinyFrame *tf, TF_Msg *msg)
+{
+    if (msg->data == tf->data) stored += 100;
+    return TF_STAY;
+}
+
+void main(void)
+{
+    uint8_t rec[RECORD_LEN];
+    int i;
+    bool good = true;
+
+    demo_tf = TF_Init(TF_MASTER);
+    TF_SetRxDest(demo_tf, recordDest);
+    TF_AddTypeListener(demo_tf, 0x10, recordListener);
+    TF_AddTypeListener(demo_tf, 0x20, otherListener);
+
+    printf("------ Records --------\n");
+
+    // records longer than TF_MAX_PAYLOAD_RX
+    for (i = 0; i < 3; i++) {
+        memset(rec, 'a' + i, sizeof(rec));
+        TF_SendSimple(demo_tf, 0x10, rec, RECORD_LEN);
+    }
+    for (i = 0; i < 3; i++) {
+        if (records[i][0] != 'a' + i || records[i][RECORD_LEN - 1] != 'a' + i) good = false;
+    }
+    printf("%d records stored\n", stored);
+    printf(good && stored == 3 ? "Records OK\n" : "Records FAIL\n");
+
+    printf("------ Other frames --------\n");
+
+    stored = 0;
+    TF_SendSimple(demo_tf, 0x20, (pu8) "hello", 5);
+    printf(stored == 100 ? "Default buffer OK\n" : "Default buffer FAIL\n");
+
+    printf("------ Corrupted record --------\n");
+
+    stored = 0;
+    do_corrupt = true;
+    TF_SendSimple(demo_tf, 0x10, rec, 10);
+    printf(stored == 0 && next_record == 3 ? "Corrupted OK\n" : "Corrupted FAIL\n");
+}
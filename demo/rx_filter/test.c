@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+TinyFrame *demo_tf;
+
+// Traffic on the link, a node receives all of it
+static uint8_t wire[1024];
+static uint32_t wire_len;
+
+static int cksum_bytes = 0;
+static int received = 0;
+
+// Simple 16-bit sum, counting the bytes
+TF_CKSUM TF_CksumStart(void)
+{
+    return 0;
+}
+
+TF_CKSUM TF_CksumAdd(TF_CKSUM cksum, uint8_t byte)
+{
+    cksum_bytes++;
+    return (TF_CKSUM) (cksum + byte);
+}
+
+TF_CKSUM TF_CksumEnd(TF_CKSUM cksum)
+{
+    return (TF_CKSUM) ~cksum;
+}
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(wire + wire_len, buff, len);
+    wire_len += len;
+}
+
+/** The only frame type this node handles */
+TF_Result sensorListener(TinyFrame *tf, TF_Msg *msg)
+{
+    received++;
+    return TF_STAY;
+}
+
+/** Put a mix of frames on the wire, 2 of them for us */
+static void make_traffic(void)
+{
+    uint8_t junk[40];
+    memset(junk, 0xAA, sizeof(junk));
+
+    wire_len = 0;
+    TF_SendSimple(demo_tf, 0x20, junk, 40); // for someone else
+    TF_SendSimple(demo_tf, 0x10, junk, 4);  // ours
+    TF_SendSimple(demo_tf, 0x10, junk, 30); // ours, but too long
+    TF_SendSimple(demo_tf, 0x30, junk, 0);  // for someone else, no payload
+    TF_SendSimple(demo_tf, 0x21, junk, 40); // for someone else
+    TF_SendSimple(demo_tf, 0x10, junk, 8);  // ours
+}
+
+/** Receive the traffic, either at once or byte by byte */
+static void receive(bool bytewise)
+{
+    uint32_t i;
+
+    received = 0;
+    cksum_bytes = 0;
+    if (bytewise) {
+        for (i = 0; i < wire_len; i++) TF_Accept(demo_tf, wire + i, 1);
+    } else {
+        TF_Accept(demo_tf, wire, wire_len);
+    }
+}
+
+void main(void)
+{
+    int all_bytes;
+
+    demo_tf = TF_Init(TF_MASTER);
+    TF_AddTypeListener(demo_tf, 0x10, sensorListener);
+    make_traffic();
+
+    printf("------ No filter --------\n");
+
+    receive(false);
+    all_bytes = cksum_bytes;
+    printf("%d frames received, %d bytes checksummed\n", received, cksum_bytes);
+    printf(received == 3 ? "Unfiltered OK\n" : "Unfiltered FAIL\n");
+
+    printf("------ Filter --------\n");
+
+    TF_SetRxFilter(demo_tf, TF_HasListener);
+    TF_SetTypeMaxLen(demo_tf, 0x10, 16);
+    receive(false);
+    printf("%d frames received, %d bytes checksummed\n", received, cksum_bytes);
+    // only the headers and the two wanted payloads are checksummed
+    printf(received == 2 && cksum_bytes == 6 * 5 + 4 + 8 ? "Filtered OK\n" : "Filtered FAIL\n");
+
+    printf("------ Filter, byte by byte --------\n");
+
+    receive(true);
+    printf("%d frames received, %d bytes checksummed (%d without the filter)\n",
+           received, cksum_bytes, all_bytes);
+    printf(received == 2 && cksum_bytes == 6 * 5 + 4 + 8 ? "Bytewise OK\n" : "Bytewise FAIL\n");
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+#define FRAME_COUNT 2000
+
+static TinyFrame sender, receiver;
+
+// The traffic, pushed to the receiver's ring by the "interrupt" thread
+static uint8_t wire[FRAME_COUNT * 32];
+static uint32_t wire_len;
+
+static int received = 0;
+static int bad = 0;
+static uint32_t expected_seq = 0;
+
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    memcpy(wire + wire_len, buff, len);
+    wire_len += len;
+}
+
+/** The frames carry a sequence number, check they all arrive in order */
+TF_Result seqListener(TinyFrame *tf, TF_Msg *msg)
+{
+    uint32_t seq;
+    memcpy(&seq, msg->data, sizeof(seq));
+    if (seq != expected_seq) bad++;
+    expected_seq = seq + 1;
+    received++;
+    return TF_STAY;
+}
+
+/** Like a UART interrupt - push the bytes in small bursts, wait when the ring is full */
+static void *producer(void *arg)
+{
+    uint32_t pos = 0;
+    uint32_t burst;
+    uint32_t n;
+    bool single = false;
+
+    while (pos < wire_len) {
+        if (single) {
+            // one byte at a time, like a byte interrupt
+            n = TF_RxPush(&receiver, wire[pos]) ? 1 : 0;
+        } else {
+            // a span, like a DMA idle-line callback
+            burst = (wire_len - pos < 7) ? wire_len - pos : 7;
+            n = TF_RxPushBuf(&receiver, wire + pos, burst);
+        }
+        if (n == 0) sched_yield(); // full, let the main loop run
+        pos += n;
+        single = !single;
+    }
+    return NULL;
+}
+
+void main(void)
+{
+    pthread_t thread;
+    uint32_t i;
+    uint8_t payload[12];
+    uint32_t processed = 0;
+
+    TF_InitStatic(&sender, TF_MASTER);
+    TF_InitStatic(&receiver, TF_SLAVE);
+    TF_AddTypeListener(&receiver, 0x22, seqListener);
+
+    memset(payload, 0xA5, sizeof(payload));
+    for (i = 0; i < FRAME_COUNT; i++) {
+        memcpy(payload, &i, sizeof(i));
+        TF_SendSimple(&sender, 0x22, payload, sizeof(payload));
+    }
+
+    printf("------ Threaded --------\n");
+
+    pthread_create(&thread, NULL, producer, NULL);
+    while (processed < wire_len) {
+        i = TF_Process(&receiver);
+        if (i == 0) sched_yield(); // nothing received yet
+        processed += i;
+    }
+    pthread_join(thread, NULL);
+
+    printf("%d frames received, %d out of order\n", received, bad);
+    printf(received == FRAME_COUNT && bad == 0 ? "Ring OK\n" : "Ring FAIL\n");
+
+    printf("------ Full ring --------\n");
+
+    // 64 bytes fit, the rest is dropped
+    i = TF_RxPushBuf(&receiver, wire, 100);
+    printf(i == 64 && !TF_RxPush(&receiver, 0) && TF_Process(&receiver) == 64 && TF_Process(&receiver) == 0
+           ? "Full OK\n" : "Full FAIL\n");
+}
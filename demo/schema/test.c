@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+#include "messages.h"
+
+TinyFrame *demo_tf;
+
+static Telemetry sent_telemetry;
+static Status sent_status;
+
+// Implemented in views.cpp
+bool check_telemetry_view(const TF_Msg *msg, const Telemetry *expect);
+bool check_status_view(const TF_Msg *msg, const Status *expect);
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    // Send it back as if we received it
+    TF_Accept(tf, buff, len);
+}
+
+TF_Result on_Telemetry(TinyFrame *tf, TF_Msg *msg, const Telemetry *m)
+{
+    bool good = msg->len == TELEMETRY_SIZE
+                && m->timestamp == sent_telemetry.timestamp
+                && m->temperature == sent_telemetry.temperature
+                && m->voltage == sent_telemetry.voltage
+                && memcmp(m->samples, sent_telemetry.samples, sizeof(m->samples)) == 0
+                && m->alarm == sent_telemetry.alarm
+                && m->position == sent_telemetry.position
+                && memcmp(m->offsets, sent_telemetry.offsets, sizeof(m->offsets)) == 0
+                && memcmp(m->raw, sent_telemetry.raw, sizeof(m->raw)) == 0
+                && memcmp(m->trims, sent_telemetry.trims, sizeof(m->trims)) == 0;
+
+    printf(good ? "Telemetry OK\n" : "Telemetry FAIL\n");
+    printf(check_telemetry_view(msg, &sent_telemetry) ? "Telemetry view OK\n" : "Telemetry view FAIL\n");
+    return TF_STAY;
+}
+
+TF_Result on_Status(TinyFrame *tf, TF_Msg *msg, const Status *m)
+{
+    bool good = m->flags == sent_status.flags
+                && strcmp(m->name, sent_status.name) == 0
+                && m->uptime == sent_status.uptime
+                && m->drift == sent_status.drift;
+
+    printf(good ? "Status OK (%d bytes)\n" : "Status FAIL\n", (int)msg->len);
+    printf(check_status_view(msg, &sent_status) ? "Status view OK\n" : "Status view FAIL\n");
+
+    // The name can also be read in place from C
+    uint32_t len;
+    PayloadParser pp = pp_start(msg->data, msg->len, NULL);
+    pp_skip(&pp, 1);
+    const char *name = pp_string_view(&pp, &len);
+    good = name != NULL && len == strlen(sent_status.name) && strcmp(name, sent_status.name) == 0;
+    good = good && pp_varint(&pp) == sent_status.uptime && pp.ok;
+    printf(good ? "Status string view OK\n" : "Status string view FAIL\n");
+    return TF_STAY;
+}
+
+TF_Result on_Ping(TinyFrame *tf, TF_Msg *msg, const Ping *m)
+{
+    printf(msg->len == 0 ? "Ping OK\n" : "Ping FAIL\n");
+    return TF_STAY;
+}
+
+void main(void)
+{
+    uint32_t i;
+    Ping ping;
+    uint8_t shortbuf[10] = {0};
+
+    demo_tf = TF_Init(TF_MASTER);
+    messages_register(demo_tf);
+
+    sent_telemetry.timestamp = 1518000000123ULL;
+    sent_telemetry.temperature = -42;
+    sent_telemetry.voltage = 3.3f;
+    for (i = 0; i < 8; i++) sent_telemetry.samples[i] = (uint16_t) (i * 1111);
+    sent_telemetry.alarm = true;
+    sent_telemetry.position = 12.5;
+    sent_telemetry.offsets[0] = -100000;
+    sent_telemetry.offsets[1] = 7;
+    memcpy(sent_telemetry.raw, "\x01\x02\x03\x04", 4);
+    sent_telemetry.trims[0] = -1;
+    sent_telemetry.trims[1] = 1;
+    Telemetry_send(demo_tf, NULL, &sent_telemetry);
+
+    sent_status.flags = 0x81;
+    strcpy(sent_status.name, "node1");
+    sent_status.uptime = 86400;
+    sent_status.drift = -3;
+    Status_send(demo_tf, NULL, &sent_status);
+
+    // The longest name that fits, its terminator fills the field
+    strcpy(sent_status.name, "ABCDEFGHIJKLMNO");
+    sent_status.drift = 1000;
+    Status_send(demo_tf, NULL, &sent_status);
+
+    Ping_send(demo_tf, NULL, &ping);
+
+    printf("This should fail:\n");
+    TF_SendSimple(demo_tf, TELEMETRY_TYPE, shortbuf, sizeof(shortbuf));
+}
@@ -0,0 +1,27 @@
+// Zero-copy views of the received messages, used by test.c
+
+#include "messages.h"
+
+using namespace messages;
+
+extern "C" bool check_telemetry_view(const TF_Msg *msg, const Telemetry *expect)
+{
+    TelemetryView v(msg);
+    if (!v.valid()) return false;
+
+    // only read what's needed, the rest is never touched
+    if (v.timestamp() != expect->timestamp) return false;
+    if (v.voltage() != expect->voltage) return false;
+    if (v.samples(TelemetryView::samples_count - 1) != expect->samples[7]) return false;
+    if (v.offsets(0) != expect->offsets[0]) return false;
+    if (v.position() != expect->position) return false;
+    if (v.trims(0) != expect->trims[0]) return false;
+    return v.raw()[3] == expect->raw[3];
+}
+
+extern "C" bool check_status_view(const TF_Msg *msg, const Status *expect)
+{
+    traits<Status>::view v(msg);
+    if (!v.valid() || v.flags() != expect->flags) return false;
+    return v.name() != NULL && strcmp(v.name(), expect->name) == 0;
+}
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+#include "tf_payload.h"
+
+TinyFrame *demo_tf;
+
+#define SAMPLE_COUNT 500
+
+// Simulated UART Rx FIFO
+static uint8_t fifo[4096];
+static uint32_t fifo_wr, fifo_rd;
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    // "Send" into the FIFO, it's read by the main loop
+    memcpy(fifo + fifo_wr, buff, len);
+    fifo_wr += len;
+}
+
+/** Stream read function - take bytes from the Rx FIFO */
+uint32_t streamRead(TinyFrame *tf, uint8_t *buf, uint32_t max)
+{
+    uint32_t n = fifo_wr - fifo_rd;
+    if (n > max) n = max;
+    if (n > 13) n = 13; // pretend the bytes arrive in small pieces
+    memcpy(buf, fifo + fifo_rd, n);
+    fifo_rd += n;
+    return n;
+}
+
+/** Decode the samples frame as it's arriving */
+TF_Result streamListener(TinyFrame *tf, TF_Msg *msg)
+{
+    TF_PayloadStream st;
+    PayloadParser *pp;
+    uint32_t i;
+    uint32_t samples[SAMPLE_COUNT];
+    uint8_t tail[5];
+    bool good = true;
+
+    if (msg->type != 0x10) return TF_NEXT;
+
+    printf("Streaming frame of %d bytes\n", (int)msg->len);
+
+    pp = TF_StreamParser(&st, tf, false);
+    if (pp_u16(pp) != SAMPLE_COUNT) good = false;
+    for (i = 0; i < 100; i++) {
+        samples[i] = pp_u32(pp);
+    }
+    // the rest in bulk, spanning many chunks
+    if (!pp_u32_array(pp, samples + 100, SAMPLE_COUNT - 100)) good = false;
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        if (samples[i] != i * 1000) good = false;
+    }
+    if (pp_buf(pp, tail, sizeof(tail)) != 5 || memcmp(tail, "tail", 5) != 0) good = false;
+    if (!pp->ok) good = false;
+
+    printf(good ? "Streamed frame OK\n" : "Streamed frame FAIL\n");
+    return TF_STAY;
+}
+
+/** Normal listener for frames not taken by the stream listener */
+TF_Result shortListener(TinyFrame *tf, TF_Msg *msg)
+{
+    dumpFrameInfo(msg);
+    if (msg->len == 6 && strcmp((const char *) msg->data, "short") == 0) {
+        printf("Short frame OK\n");
+    } else {
+        printf("Short frame FAIL\n");
+    }
+    return TF_STAY;
+}
+
+/** Main loop - pass received bytes to TinyFrame */
+void pumpRx(void)
+{
+    uint32_t n;
+    while (fifo_rd < fifo_wr) {
+        n = fifo_wr - fifo_rd;
+        if (n > 7) n = 7;
+        fifo_rd += n;
+        TF_Accept(demo_tf, fifo + fifo_rd - n, n);
+    }
+    fifo_rd = fifo_wr = 0;
+}
+
+void main(void)
+{
+    TF_Msg msg;
+    PayloadBuilder pb;
+    uint32_t i;
+
+    demo_tf = TF_Init(TF_MASTER);
+    TF_SetStreamListener(demo_tf, streamListener, streamRead);
+    TF_AddTypeListener(demo_tf, 0x20, shortListener);
+
+    printf("------ Frame much larger than the Rx buffer --------\n");
+
+    TF_ClearMsg(&msg);
+    msg.type = 0x10;
+    msg.len = 2 + SAMPLE_COUNT * 4 + 5;
+    TF_Send_Builder(demo_tf, &msg, &pb, false);
+    pb_u16(&pb, SAMPLE_COUNT);
+    for (i = 0; i < SAMPLE_COUNT; i++) {
+        pb_u32(&pb, i * 1000);
+    }
+    pb_string(&pb, "tail");
+    TF_Builder_Close(demo_tf, &pb);
+
+    // a short frame follows in the same FIFO
+    TF_SendSimple(demo_tf, 0x20, (pu8) "short", 6);
+
+    pumpRx();
+}
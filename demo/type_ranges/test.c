@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <string.h>
+#include "../../TinyFrame.h"
+#include "../utils.h"
+
+TinyFrame *demo_tf;
+
+// Which listener got the last frame
+static char got = 0;
+static int tapped = 0;
+
+/**
+ * This function should be defined in the application code.
+ * It implements the lowest layer - sending bytes to UART (or other)
+ */
+void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len)
+{
+    // send to the same instance (loopback)
+    TF_Accept(tf, buff, len);
+}
+
+/** Range 0x40-0x7F, e.g. sensor readings */
+TF_Result sensorListener(TinyFrame *tf, TF_Msg *msg)
+{
+    got = 'S';
+    return TF_STAY;
+}
+
+/** Mask 0x80/0x81 - odd types over 0x80 are events; passes on the even ones */
+TF_Result eventListener(TinyFrame *tf, TF_Msg *msg)
+{
+    got = 'E';
+    return TF_STAY;
+}
+
+/** Range 0x50-0x5F, overlapping the sensor range - sees the frames first, passes them on */
+TF_Result tapListener(TinyFrame *tf, TF_Msg *msg)
+{
+    tapped++;
+    return TF_NEXT;
+}
+
+/** Catches everything else */
+TF_Result fallbackListener(TinyFrame *tf, TF_Msg *msg)
+{
+    got = 'G';
+    return TF_STAY;
+}
+
+/** Send a frame and check which listener handled it */
+static bool expect(TF_TYPE type, char who)
+{
+    got = 0;
+    TF_SendSimple(demo_tf, type, (pu8) "x", 1);
+    if (got != who) {
+        printf("Type 0x%02X went to '%c', expected '%c'\n", (int)type, got ? got : '-', who);
+        return false;
+    }
+    return true;
+}
+
+void main(void)
+{
+    bool good = true;
+    int i;
+
+    demo_tf = TF_Init(TF_MASTER);
+    TF_AddGenericListener(demo_tf, fallbackListener);
+
+    printf("------ Ranges and masks --------\n");
+
+    TF_AddTypeRangeListener(demo_tf, 0x40, 0x7F, sensorListener);
+    TF_AddTypeMaskListener(demo_tf, 0x81, 0x81, eventListener);
+
+    good &= expect(0x3F, 'G');
+    good &= expect(0x40, 'S');
+    good &= expect(0x7F, 'S');
+    good &= expect(0x80, 'G');
+    good &= expect(0x81, 'E');
+    good &= expect(0xC3, 'E');
+    good &= expect(0xFF, 'E');
+    good &= expect(0xFE, 'G');
+    printf(good ? "Dispatch OK\n" : "Dispatch FAIL\n");
+
+    printf("------ Overlaps --------\n");
+
+    // Overlapping listeners are tried in the order they were added
+    TF_AddTypeRangeListener(demo_tf, 0x50, 0x5F, tapListener);
+    good = true;
+    good &= expect(0x55, 'S'); // the sensor listener is first and doesn't pass the frame on
+    good &= tapped == 0;
+
+    TF_RemoveTypeRangeListener(demo_tf, 0x40, 0x7F);
+    TF_AddTypeRangeListener(demo_tf, 0x40, 0x7F, sensorListener);
+    good &= expect(0x55, 'S'); // now the tap sees it first and passes it on
+    good &= tapped == 1;
+    good &= expect(0x60, 'S');
+    good &= expect(0x4F, 'S');
+    good &= tapped == 1;
+    printf(good ? "Overlaps OK\n" : "Overlaps FAIL\n");
+
+    printf("------ Removal --------\n");
+
+    good = true;
+    good &= TF_RemoveTypeMaskListener(demo_tf, 0x81, 0x81);
+    good &= TF_RemoveTypeRangeListener(demo_tf, 0x50, 0x5F);
+    good &= !TF_RemoveTypeRangeListener(demo_tf, 0x50, 0x5F); // already gone
+    good &= expect(0x81, 'G');
+    good &= expect(0x55, 'S');
+    good &= TF_RemoveTypeRangeListener(demo_tf, 0x40, 0x7F);
+    good &= expect(0x55, 'G');
+    good &= demo_tf->count_range_lst == 0;
+
+    // fill the table
+    for (i = 0; i < 8; i++) {
+        good &= TF_AddTypeRangeListener(demo_tf, (TF_TYPE) (i * 0x10), (TF_TYPE) (i * 0x10 + 7), sensorListener);
+    }
+    good &= !TF_AddTypeRangeListener(demo_tf, 0xF0, 0xFF, sensorListener);
+    good &= expect(0x23, 'S');
+    good &= expect(0x28, 'G');
+    printf(good ? "Removal OK\n" : "Removal FAIL\n");
+}
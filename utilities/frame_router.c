@@ -0,0 +1,148 @@
+#include <string.h>
+#include "frame_router.h"
+
+// The peer bit is the MSb of the ID, see TinyFrame.c
+#define FR_ID_PEERBIT ((TF_ID) ((TF_ID) 1 << (sizeof(TF_ID) * 8 - 1)))
+
+void fr_init(FrameRouter *fr)
+{
+    memset(fr, 0, sizeof(FrameRouter));
+}
+
+bool fr_add_route(FrameRouter *fr, TinyFrame *from, TF_TYPE first, TF_TYPE last, TinyFrame *to)
+{
+    return fr_add_route_multi(fr, from, first, last, to, 0);
+}
+
+bool fr_add_route_multi(FrameRouter *fr, TinyFrame *from, TF_TYPE first, TF_TYPE last, TinyFrame *to,
+                        TF_TICKS timeout)
+{
+    FrameRoute *r;
+
+    if (fr->route_count == FR_MAX_ROUTES) {
+        TF_Error("Failed to add route");
+        return false;
+    }
+
+    r = &fr->routes[fr->route_count++];
+    r->from = from;
+    r->first = first;
+    r->last = last;
+    r->to = to;
+    r->timeout = timeout;
+    return true;
+}
+
+void fr_remove_instance(FrameRouter *fr, TinyFrame *tf)
+{
+    uint32_t i, n = 0;
+    FrameMapping *m;
+
+    // keep the rules in order
+    for (i = 0; i < fr->route_count; i++) {
+        if (fr->routes[i].from != tf && fr->routes[i].to != tf) {
+            fr->routes[n++] = fr->routes[i];
+        }
+    }
+    fr->route_count = n;
+
+    for (i = 0; i < FR_MAX_MAPPINGS; i++) {
+        m = &fr->mappings[i];
+        if (m->tf == tf || m->orig_tf == tf) {
+            m->tf = NULL;
+        }
+    }
+}
+
+/** Find the request a response belongs to */
+static FrameMapping *fr_find_mapping(FrameRouter *fr, TinyFrame *tf, TF_ID id)
+{
+    uint32_t i;
+    FrameMapping *m;
+
+    for (i = 0; i < FR_MAX_MAPPINGS; i++) {
+        m = &fr->mappings[i];
+        if (m->tf == tf && m->id == id) return m;
+    }
+    return NULL;
+}
+
+/** Remember the original ID of a forwarded request */
+static void fr_add_mapping(FrameRouter *fr, TinyFrame *tf, TF_ID id, TinyFrame *orig_tf, TF_ID orig_id, TF_TICKS timeout)
+{
+    uint32_t i;
+    FrameMapping *m;
+
+    // A free slot, or the oldest one if all are used
+    for (i = 0; i < FR_MAX_MAPPINGS - 1; i++) {
+        if (fr->mappings[fr->next_mapping].tf == NULL) break;
+        fr->next_mapping = (fr->next_mapping + 1) % FR_MAX_MAPPINGS;
+    }
+
+    m = &fr->mappings[fr->next_mapping];
+    m->tf = tf;
+    m->id = id;
+    m->orig_tf = orig_tf;
+    m->orig_id = orig_id;
+    m->timeout = timeout;
+    m->timeout_max = timeout;
+
+    fr->next_mapping = (fr->next_mapping + 1) % FR_MAX_MAPPINGS;
+}
+
+void fr_tick(FrameRouter *fr)
+{
+    uint32_t i;
+    FrameMapping *m;
+
+    for (i = 0; i < FR_MAX_MAPPINGS; i++) {
+        m = &fr->mappings[i];
+        if (m->tf == NULL || m->timeout == 0) continue;
+        // no more responses are expected
+        if (--m->timeout == 0) {
+            m->tf = NULL;
+        }
+    }
+}
+
+TF_Result fr_route(FrameRouter *fr, TinyFrame *tf, TF_Msg *msg)
+{
+    uint32_t i;
+    FrameRoute *r;
+    FrameMapping *m;
+    TF_Msg fwd;
+    bool routed = false;
+
+    // An ID with our peer bit - a response to a frame sent by this instance
+    if (((msg->frame_id & FR_ID_PEERBIT) != 0) == (tf->peer_bit != 0)) {
+        m = fr_find_mapping(fr, tf, msg->frame_id);
+        if (m != NULL) {
+            fwd = *msg;
+            fwd.frame_id = m->orig_id;
+            fwd.is_response = true;
+            TF_Forward(m->orig_tf, tf, &fwd);
+
+            if (m->timeout_max == 0) {
+                m->tf = NULL; // the only response
+            } else {
+                m->timeout = m->timeout_max; // renew, more may follow
+            }
+            return TF_STAY;
+        }
+    }
+
+    for (i = 0; i < fr->route_count; i++) {
+        r = &fr->routes[i];
+        if ((r->from != NULL && r->from != tf) || r->to == tf) continue;
+        if (msg->type < r->first || msg->type > r->last) continue;
+
+        fwd = *msg;
+        fwd.is_response = false; // gets a new ID
+        if (TF_Forward(r->to, tf, &fwd)) {
+            fr_add_mapping(fr, r->to, fwd.frame_id, tf, msg->frame_id, r->timeout);
+            routed = true;
+        }
+    }
+
+    return routed ? TF_STAY : TF_NEXT;
+}
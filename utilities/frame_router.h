@@ -0,0 +1,135 @@
+#ifndef FRAME_ROUTER_H
+#define FRAME_ROUTER_H
+
+/**
+ * FrameRouter, part of the TinyFrame utilities collection
+ *
+ * (c) Ondřej Hruška, 2018. MIT license.
+ *
+ * Forwards frames between TinyFrame instances, e.g. in a gateway between
+ * a serial link and TCP connections.
+ *
+ * Frames are forwarded by rules matching the receiving instance and a range
+ * of types. The payload isn't copied or checksummed again (see TF_Forward()).
+ *
+ * A forwarded request gets a new frame ID on the outgoing instance, and the
+ * router remembers where it came from. Responses to it (frames with that ID,
+ * coming back on that instance) are forwarded back with the original ID,
+ * so the ID listener of the requester gets them.
+ *
+ * The mapping is cleared when the response is forwarded. Requests routed by
+ * a rule added with fr_add_route_multi() can get several responses; their
+ * mapping is kept until no response comes for the rule's timeout, counted
+ * by fr_tick() (call it with TF_Tick()).
+ *
+ * The router is fed from a listener of each instance, e.g. a Generic listener:
+ *
+ *     TF_Result gatewayListener(TinyFrame *tf, TF_Msg *msg)
+ *     {
+ *         return fr_route(&router, tf, msg);
+ *     }
+ *
+ * Responses must not be fed back to the router from inside TF_WriteImpl()
+ * of the forwarded request (the ID mapping is stored after it's written).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "TinyFrame.h"
+
+/** Max number of forwarding rules */
+#ifndef FR_MAX_ROUTES
+#define FR_MAX_ROUTES 16
+#endif
+
+/** Number of remembered request IDs; the oldest mapping is replaced when full */
+#ifndef FR_MAX_MAPPINGS
+#define FR_MAX_MAPPINGS 32
+#endif
+
+/** Forwarding rule */
+typedef struct {
+    TinyFrame *from;    //!< Instance receiving the frames, NULL for any
+    TF_TYPE first;      //!< First type forwarded
+    TF_TYPE last;       //!< Last type forwarded
+    TinyFrame *to;      //!< Instance to send the frames with
+    TF_TICKS timeout;   //!< Ticks to wait for more responses, 0 = one response
+} FrameRoute;
+
+/** ID of a forwarded request, to route the responses back */
+typedef struct {
+    TinyFrame *tf;      //!< Instance the request was forwarded with, NULL if unused
+    TF_ID id;           //!< ID assigned by it
+    TinyFrame *orig_tf; //!< Instance the request came from
+    TF_ID orig_id;      //!< Its original ID
+    TF_TICKS timeout;     //!< Ticks remaining until the mapping expires
+    TF_TICKS timeout_max; //!< The rule's timeout (0 = cleared by the first response)
+} FrameMapping;
+
+/** The router */
+typedef struct {
+    FrameRoute routes[FR_MAX_ROUTES];
+    uint32_t route_count;
+    FrameMapping mappings[FR_MAX_MAPPINGS];
+    uint32_t next_mapping; //!< Slot used for the next mapping
+} FrameRouter;
+
+/** Initialize a router */
+void fr_init(FrameRouter *fr);
+
+/**
+ * Add a forwarding rule. A frame matching several rules is forwarded by all of them
+ * (but never back to the instance it came from).
+ *
+ * @param fr - router
+ * @param from - instance receiving the frames, NULL for any
+ * @param first - first type forwarded
+ * @param last - last type forwarded
+ * @param to - instance to send the frames with
+ * @return success (false if the table is full)
+ */
+bool fr_add_route(FrameRouter *fr, TinyFrame *from, TF_TYPE first, TF_TYPE last, TinyFrame *to);
+
+/**
+ * Add a forwarding rule for requests with several responses (e.g. a subscription).
+ * The ID mapping of a forwarded request is kept until no response comes for 'timeout'
+ * ticks (see fr_tick()), like an ID listener renewed by each frame.
+ *
+ * @param fr - router
+ * @param from - instance receiving the frames, NULL for any
+ * @param first - first type forwarded
+ * @param last - last type forwarded
+ * @param to - instance to send the frames with
+ * @param timeout - ticks to wait for the next response, 0 = only one response
+ * @return success (false if the table is full)
+ */
+bool fr_add_route_multi(FrameRouter *fr, TinyFrame *from, TF_TYPE first, TF_TYPE last, TinyFrame *to,
+                        TF_TICKS timeout);
+
+/**
+ * Remove the rules and ID mappings involving an instance (e.g. when a connection is closed).
+ *
+ * @param fr - router
+ * @param tf - instance
+ */
+void fr_remove_instance(FrameRouter *fr, TinyFrame *tf);
+
+/**
+ * Timebase hook - expire the mappings of requests with several responses.
+ * Call it with the same period as TF_Tick().
+ *
+ * @param fr - router
+ */
+void fr_tick(FrameRouter *fr);
+
+/**
+ * Route a received frame. Call this from a listener of the receiving instance.
+ *
+ * @param fr - router
+ * @param tf - instance that received the frame
+ * @param msg - the frame
+ * @return TF_STAY if the frame was forwarded, TF_NEXT if no rule matched
+ */
+TF_Result fr_route(FrameRouter *fr, TinyFrame *tf, TF_Msg *msg);
+
+#endif // FRAME_ROUTER_H
@@ -0,0 +1,116 @@
+#include "payload_arena.h"
+
+/** Get a chunk from the free list, the memory block or the alloc callback */
+static PayloadChunk *pa_take(PayloadArena *pa)
+{
+    PayloadChunk *c;
+    uint32_t footprint = (uint32_t) pa_chunk_footprint(pa->chunk_size);
+
+    if (pa->free != NULL) {
+        c = pa->free;
+        pa->free = c->next;
+    }
+    else if (pa->mem != NULL && (uint32_t) (pa->mem_end - pa->mem) >= footprint) {
+        c = (PayloadChunk *) pa->mem;
+        pa->mem += footprint;
+    }
+    else if (pa->alloc != NULL) {
+        c = pa->alloc(footprint);
+        if (c == NULL) return NULL;
+    }
+    else {
+        return NULL;
+    }
+
+    c->next = NULL;
+    c->len = 0;
+    return c;
+}
+
+/** Full handler - continue in a new chunk */
+static bool pa_full(PayloadBuilder *pb, uint32_t needed)
+{
+    PayloadChain *pc = pb->userdata;
+    PayloadChunk *c;
+
+    if (needed > pc->arena->chunk_size) return false;
+
+    c = pa_take(pc->arena);
+    if (c == NULL) return false;
+
+    pc->tail->len = (uint32_t) pb_length(pb);
+    pc->tail->next = c;
+    pc->tail = c;
+
+    pb->start = pb->current = c->data;
+    pb->end = c->data + pc->arena->chunk_size;
+    return true;
+}
+
+void pa_init(PayloadArena *pa, void *mem, uint32_t size, uint32_t chunk_size, pa_alloc_fn alloc)
+{
+    uintptr_t skip;
+
+    // The chunks are carved from an aligned address
+    if (mem != NULL) {
+        skip = (sizeof(void *) - ((uintptr_t) mem % sizeof(void *))) % sizeof(void *);
+        if (skip > size) skip = size;
+
+        pa->mem = (uint8_t *) mem + skip;
+        pa->mem_end = (uint8_t *) mem + size;
+    } else {
+        // Heap only, no pointer arithmetic on NULL
+        pa->mem = pa->mem_end = NULL;
+    }
+    pa->free = NULL;
+    pa->chunk_size = chunk_size;
+    pa->alloc = alloc;
+}
+
+PayloadBuilder *pa_start(PayloadChain *pc, PayloadArena *pa, bool bigendian)
+{
+    PayloadChunk *c = pa_take(pa);
+
+    pc->arena = pa;
+    pc->head = pc->tail = c;
+
+    if (c == NULL) {
+        pc->pb = pb_start_e(NULL, 0, bigendian, NULL);
+        pc->pb.ok = false;
+    } else {
+        pc->pb = pb_start_e(c->data, pa->chunk_size, bigendian, pa_full);
+    }
+    pc->pb.userdata = pc;
+    return &pc->pb;
+}
+
+PayloadChunk *pa_chunks(PayloadChain *pc)
+{
+    if (pc->tail != NULL) {
+        pc->tail->len = (uint32_t) pb_length(&pc->pb);
+    }
+    return pc->head;
+}
+
+uint32_t pa_length(PayloadChain *pc)
+{
+    PayloadChunk *c;
+    uint32_t len = 0;
+
+    for (c = pa_chunks(pc); c != NULL; c = c->next) {
+        len += c->len;
+    }
+    return len;
+}
+
+void pa_release(PayloadChain *pc)
+{
+    if (pc->head != NULL) {
+        pc->tail->next = pc->arena->free;
+        pc->arena->free = pc->head;
+    }
+
+    pc->head = pc->tail = NULL;
+    pc->pb = pb_start_e(NULL, 0, pc->pb.bigendian, NULL);
+    pc->pb.ok = false;
+}
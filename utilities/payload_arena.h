@@ -0,0 +1,104 @@
+#ifndef PAYLOAD_ARENA_H
+#define PAYLOAD_ARENA_H
+
+/**
+ * PayloadArena, part of the TinyFrame utilities collection
+ *
+ * (c) Ondřej Hruška, 2018. MIT license.
+ *
+ * A PayloadBuilder that grows as needed, writing into a chain of fixed-size
+ * chunks taken from an arena.
+ *
+ * The arena is a memory block (e.g. a static array) that is cut into chunks
+ * on demand. Released chunks go to a free list and are reused, so once the
+ * arena has served the largest payload, building needs no more memory.
+ * When the block is used up, the arena can optionally grow using an
+ * allocation callback (e.g. a wrapper of malloc).
+ *
+ * The payload is not flattened - the chunks are sent one by one
+ * (see TF_Send_Chain()) or can be iterated using pa_chunks().
+ *
+ * Arenas are not locked, use one arena per thread.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "payload_builder.h"
+
+typedef struct PayloadChunk_ PayloadChunk;
+
+/** A chunk of payload data */
+struct PayloadChunk_ {
+    PayloadChunk *next; //!< Next chunk of the chain (or in the free list)
+    uint32_t len;       //!< Number of bytes used
+    uint8_t data[];     //!< The data, the arena's chunk_size bytes
+};
+
+/**
+ * Allocation callback, used when the arena's memory block is used up.
+ * Return NULL if the memory can't be allocated.
+ */
+typedef void *(*pa_alloc_fn)(uint32_t size);
+
+/** Arena providing the chunks */
+typedef struct {
+    uint8_t *mem;           //!< Unused part of the memory block
+    uint8_t *mem_end;       //!< End of the memory block
+    PayloadChunk *free;     //!< Released chunks
+    uint32_t chunk_size;    //!< Data bytes per chunk
+    pa_alloc_fn alloc;      //!< Callback to get more memory, or NULL
+} PayloadArena;
+
+/** Builder writing into a chain of chunks */
+typedef struct {
+    PayloadBuilder pb;      //!< The builder, use with the pb_* functions
+    PayloadArena *arena;    //!< The arena supplying the chunks
+    PayloadChunk *head;     //!< First chunk of the payload
+    PayloadChunk *tail;     //!< Chunk being written
+} PayloadChain;
+
+/** Size of memory taken by a chunk with the given data size */
+#define pa_chunk_footprint(chunk_size) \
+    ((sizeof(PayloadChunk) + (chunk_size) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/**
+ * Initialize an arena.
+ *
+ * @param pa - arena
+ * @param mem - memory block to cut the chunks from, can be NULL if alloc is given
+ * @param size - size of the memory block
+ * @param chunk_size - data bytes per chunk; a single write (except strings, buffers
+ *                     and arrays, which are split) must fit in one chunk
+ * @param alloc - callback to get more memory when the block is used up, or NULL
+ */
+void pa_init(PayloadArena *pa, void *mem, uint32_t size, uint32_t chunk_size, pa_alloc_fn alloc);
+
+/**
+ * Start building a payload.
+ *
+ * If the arena has no chunk to give, pc->pb.ok is cleared.
+ *
+ * @param pc - chain to initialize
+ * @param pa - arena
+ * @param bigendian - use big-endian encoding
+ * @return the builder
+ */
+PayloadBuilder *pa_start(PayloadChain *pc, PayloadArena *pa, bool bigendian);
+
+/**
+ * Get the first chunk of the payload, to iterate over the chain.
+ * Call this again after writing more data.
+ */
+PayloadChunk *pa_chunks(PayloadChain *pc);
+
+/** Get the total payload length */
+uint32_t pa_length(PayloadChain *pc);
+
+/**
+ * Give the chunks back to the arena, to be reused by another payload.
+ * The chain can't be used afterwards (until started again).
+ */
+void pa_release(PayloadChain *pc);
+
+#endif // PAYLOAD_ARENA_H
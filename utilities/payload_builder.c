@@ -9,6 +9,24 @@
 /** Write from a buffer */
 bool pb_buf(PayloadBuilder *pb, const uint8_t *buf, uint32_t len)
 {
+    uint32_t chunk;
+
+    // With a full handler, fill the buffer and let the handler make room for the rest
+    while (pb->ok && pb->full_handler != NULL && pb->current + len > pb->end) {
+        chunk = (uint32_t) (pb->end - pb->current);
+        if (chunk > 0) {
+            memcpy(pb->current, buf, chunk);
+            pb->current += chunk;
+            buf += chunk;
+            len -= chunk;
+        }
+        pb_check_capacity(pb, 1);
+        if (pb->ok && pb->current == pb->end) {
+            // The handler didn't make any room
+            pb->ok = 0;
+        }
+    }
+
     pb_check_capacity(pb, len);
     if (!pb->ok) return false;
 
@@ -20,13 +38,7 @@ bool pb_buf(PayloadBuilder *pb, const uint8_t *buf, uint32_t len)
 /** Write s zero terminated string */
 bool pb_string(PayloadBuilder *pb, const char *str)
 {
-    uint32_t len = (uint32_t) strlen(str);
-    pb_check_capacity(pb, len+1);
-    if (!pb->ok) return false;
-
-    memcpy(pb->current, str, len+1);
-    pb->current += len+1;
-    return true;
+    return pb_buf(pb, (const uint8_t *) str, (uint32_t) strlen(str) + 1);
 }
 
 /** Write uint8_t to the buffer */
@@ -42,39 +54,56 @@ bool pb_u8(PayloadBuilder *pb, uint8_t byte)
 /** Write uint16_t to the buffer. */
 bool pb_u16(PayloadBuilder *pb, uint16_t word)
 {
-    pb_check_capacity(pb, 2);
-    if (!pb->ok) return false;
-
-    if (pb->bigendian) {
-        *pb->current++ = (uint8_t) ((word >> 8) & 0xFF);
-        *pb->current++ = (uint8_t) (word & 0xFF);
-    } else {
-        *pb->current++ = (uint8_t) (word & 0xFF);
-        *pb->current++ = (uint8_t) ((word >> 8) & 0xFF);
-    }
-    return true;
+    return pb->bigendian ? pb_be_u16(pb, word) : pb_le_u16(pb, word);
 }
 
 /** Write uint32_t to the buffer. */
 bool pb_u32(PayloadBuilder *pb, uint32_t word)
 {
-    pb_check_capacity(pb, 4);
+    return pb->bigendian ? pb_be_u32(pb, word) : pb_le_u32(pb, word);
+}
+
+/** Write uint64_t to the buffer. */
+bool pb_u64(PayloadBuilder *pb, uint64_t word)
+{
+    pb_check_capacity(pb, 8);
     if (!pb->ok) return false;
 
     if (pb->bigendian) {
-        *pb->current++ = (uint8_t) ((word >> 24) & 0xFF);
-        *pb->current++ = (uint8_t) ((word >> 16) & 0xFF);
-        *pb->current++ = (uint8_t) ((word >> 8) & 0xFF);
-        *pb->current++ = (uint8_t) (word & 0xFF);
+        pb_be_u32(pb, (uint32_t) (word >> 32));
+        pb_be_u32(pb, (uint32_t) word);
     } else {
-        *pb->current++ = (uint8_t) (word & 0xFF);
-        *pb->current++ = (uint8_t) ((word >> 8) & 0xFF);
-        *pb->current++ = (uint8_t) ((word >> 16) & 0xFF);
-        *pb->current++ = (uint8_t) ((word >> 24) & 0xFF);
+        pb_le_u32(pb, (uint32_t) word);
+        pb_le_u32(pb, (uint32_t) (word >> 32));
     }
     return true;
 }
 
+/** Write an unsigned varint */
+bool pb_varint(PayloadBuilder *pb, uint64_t num)
+{
+    uint8_t tmp[10];
+    uint32_t len = 0;
+
+    if (num < 0x80) {
+        return pb_u8(pb, (uint8_t) num);
+    }
+
+    while (num >= 0x80) {
+        tmp[len++] = (uint8_t) ((num & 0x7F) | 0x80);
+        num >>= 7;
+    }
+    tmp[len++] = (uint8_t) num;
+
+    return pb_buf(pb, tmp, len);
+}
+
+/** Write a signed (zigzag) varint */
+bool pb_svarint(PayloadBuilder *pb, int64_t num)
+{
+    return pb_varint(pb, tc_zigzag_enc(num));
+}
+
 /** Write int8_t to the buffer. */
 bool pb_i8(PayloadBuilder *pb, int8_t byte)
 {
@@ -98,3 +127,75 @@ bool pb_float(PayloadBuilder *pb, float f)
 {
     return pb_u32(pb, ((union conv32){.f32 = f}).u32);
 }
+
+/** Write int64_t to the buffer. */
+bool pb_i64(PayloadBuilder *pb, int64_t word)
+{
+    return pb_u64(pb, ((union conv64){.i64 = word}).u64);
+}
+
+/** Write 8-byte double to the buffer. */
+bool pb_double(PayloadBuilder *pb, double d)
+{
+    return pb_u64(pb, ((union conv64){.f64 = d}).u64);
+}
+
+/**
+ * Write an array of 2- or 4-byte numbers. The bounds are checked once for each
+ * contiguous piece of the output (just once, unless a full handler flushes it).
+ */
+static bool pb_array(PayloadBuilder *pb, const void *in, uint32_t count, uint32_t size)
+{
+    const uint8_t *src = in;
+    uint32_t n;
+
+    while (count > 0) {
+        // With a full handler, the array can be written in pieces
+        pb_check_capacity(pb, pb->full_handler ? size : count * size);
+        if (!pb->ok) return false;
+
+        n = (uint32_t) (pb->end - pb->current) / size;
+        if (n > count) n = count;
+        if (n == 0) {
+            // The handler left less than one item of room
+            pb->ok = 0;
+            return false;
+        }
+
+#if TC_HOST_ENDIAN_KNOWN
+        memcpy(pb->current, src, n * size);
+        if (pb->bigendian != TC_HOST_BIGENDIAN) {
+            if (size == 2) tc_bswap16_array(pb->current, n);
+            else tc_bswap32_array(pb->current, n);
+        }
+        pb->current += n * size;
+#else
+        uint32_t i;
+        for (i = 0; i < n; i++) {
+            if (size == 2) pb_u16(pb, ((const uint16_t *) src)[i]);
+            else pb_u32(pb, ((const uint32_t *) src)[i]);
+        }
+#endif
+        src += n * size;
+        count -= n;
+    }
+    return true;
+}
+
+/** Write an array of uint16_t */
+bool pb_u16_array(PayloadBuilder *pb, const uint16_t *arr, uint32_t count)
+{
+    return pb_array(pb, arr, count, 2);
+}
+
+/** Write an array of uint32_t */
+bool pb_u32_array(PayloadBuilder *pb, const uint32_t *arr, uint32_t count)
+{
+    return pb_array(pb, arr, count, 4);
+}
+
+/** Write an array of 4-byte floats */
+bool pb_float_array(PayloadBuilder *pb, const float *arr, uint32_t count)
+{
+    return pb_array(pb, arr, count, 4);
+}
@@ -43,12 +43,14 @@ struct PayloadBuilder_ {
     pb_full_handler full_handler; //!< Callback for buffer overrun
     bool bigendian;   //!< Flag to use big-endian parsing
     bool ok;          //!< Indicates that all reads were successful
+    void *userdata;   //!< Custom user data for the full_handler
+    uint32_t flushed; //!< Bytes flushed by the full_handler (its own counter, pb_length() doesn't include them)
 };
 
 // --- initializer helper macros ---
 
 /** Start the builder. */
-#define pb_start_e(buf, capacity, bigendian, full_handler) ((PayloadBuilder){buf, buf, (buf)+(capacity), full_handler, bigendian, 1})
+#define pb_start_e(buf, capacity, bigendian, full_handler) ((PayloadBuilder){buf, buf, (buf)+(capacity), full_handler, bigendian, 1, NULL, 0})
 
 /** Start the builder in big-endian mode */
 #define pb_start_be(buf, capacity, full_handler) pb_start_e(buf, capacity, 1, full_handler)
@@ -68,10 +70,15 @@ struct PayloadBuilder_ {
 #define pb_rewind(pb) do { pb->current = pb->start; } while (0)
 
 
-/** Write from a buffer */
+/**
+ * Write from a buffer
+ *
+ * If the full handler is called, the data is written in pieces - the handler
+ * is asked for room for the rest (with needed = 1) each time the buffer fills up.
+ */
 bool pb_buf(PayloadBuilder *pb, const uint8_t *buf, uint32_t len);
 
-/** Write a zero terminated string */
+/** Write a zero terminated string, see pb_buf() */
 bool pb_string(PayloadBuilder *pb, const char *str);
 
 /** Write uint8_t to the buffer */
@@ -107,4 +114,119 @@ bool pb_i32(PayloadBuilder *pb, int32_t word);
 /** Write 4-byte float to the buffer. */
 bool pb_float(PayloadBuilder *pb, float f);
 
+/** Write uint64_t to the buffer. */
+bool pb_u64(PayloadBuilder *pb, uint64_t word);
+
+/** Write int64_t to the buffer. */
+bool pb_i64(PayloadBuilder *pb, int64_t word);
+
+/** Write 8-byte double to the buffer. */
+bool pb_double(PayloadBuilder *pb, double d);
+
+/** Write an unsigned LEB128 varint (7 bits per byte, low bits first, 1-10 bytes). */
+bool pb_varint(PayloadBuilder *pb, uint64_t num);
+
+/** Write a signed number as a zigzag-encoded varint (small magnitudes take 1 byte). */
+bool pb_svarint(PayloadBuilder *pb, int64_t num);
+
+/**
+ * Write an array of uint16_t to the buffer.
+ *
+ * This is much faster than writing the elements one by one - the bounds
+ * are checked once and the data copied in bulk, swapping bytes if needed.
+ * If the full handler is called, the array is written in pieces that fit.
+ */
+bool pb_u16_array(PayloadBuilder *pb, const uint16_t *arr, uint32_t count);
+
+/** Write an array of uint32_t to the buffer, see pb_u16_array(). */
+bool pb_u32_array(PayloadBuilder *pb, const uint32_t *arr, uint32_t count);
+
+/** Write an array of 4-byte floats to the buffer, see pb_u16_array(). */
+bool pb_float_array(PayloadBuilder *pb, const float *arr, uint32_t count);
+
+// --- endian-specific inline writers ---
+// Those don't check the bigendian flag and are inlined, so the compiler can
+// turn them into plain stores and merge the bounds checks of consecutive writes.
+
+/** Check that 'needed' bytes can be written, calling the full handler if not. */
+static inline bool pb_ensure(PayloadBuilder *pb, uint32_t needed)
+{
+    if (pb->current + needed > pb->end) {
+        if (pb->full_handler == NULL || !pb->full_handler(pb, needed)) pb->ok = 0;
+    }
+    return pb->ok;
+}
+
+/** Write little-endian uint16_t */
+static inline bool pb_le_u16(PayloadBuilder *pb, uint16_t word)
+{
+    if (!pb_ensure(pb, 2)) return false;
+    tc_store_le16(pb->current, word);
+    pb->current += 2;
+    return true;
+}
+
+/** Write big-endian uint16_t */
+static inline bool pb_be_u16(PayloadBuilder *pb, uint16_t word)
+{
+    if (!pb_ensure(pb, 2)) return false;
+    tc_store_be16(pb->current, word);
+    pb->current += 2;
+    return true;
+}
+
+/** Write little-endian uint32_t */
+static inline bool pb_le_u32(PayloadBuilder *pb, uint32_t word)
+{
+    if (!pb_ensure(pb, 4)) return false;
+    tc_store_le32(pb->current, word);
+    pb->current += 4;
+    return true;
+}
+
+/** Write big-endian uint32_t */
+static inline bool pb_be_u32(PayloadBuilder *pb, uint32_t word)
+{
+    if (!pb_ensure(pb, 4)) return false;
+    tc_store_be32(pb->current, word);
+    pb->current += 4;
+    return true;
+}
+
+/** Write little-endian int16_t */
+static inline bool pb_le_i16(PayloadBuilder *pb, int16_t word)
+{
+    return pb_le_u16(pb, ((union conv16){.i16 = word}).u16);
+}
+
+/** Write big-endian int16_t */
+static inline bool pb_be_i16(PayloadBuilder *pb, int16_t word)
+{
+    return pb_be_u16(pb, ((union conv16){.i16 = word}).u16);
+}
+
+/** Write little-endian int32_t */
+static inline bool pb_le_i32(PayloadBuilder *pb, int32_t word)
+{
+    return pb_le_u32(pb, ((union conv32){.i32 = word}).u32);
+}
+
+/** Write big-endian int32_t */
+static inline bool pb_be_i32(PayloadBuilder *pb, int32_t word)
+{
+    return pb_be_u32(pb, ((union conv32){.i32 = word}).u32);
+}
+
+/** Write little-endian 4-byte float */
+static inline bool pb_le_float(PayloadBuilder *pb, float f)
+{
+    return pb_le_u32(pb, ((union conv32){.f32 = f}).u32);
+}
+
+/** Write big-endian 4-byte float */
+static inline bool pb_be_float(PayloadBuilder *pb, float f)
+{
+    return pb_be_u32(pb, ((union conv32){.f32 = f}).u32);
+}
+
 #endif // PAYLOAD_BUILDER_H
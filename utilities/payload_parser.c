@@ -1,3 +1,4 @@
+#include <string.h>
 #include "payload_parser.h"
 
 #define pp_check_capacity(pp, needed) \
@@ -20,40 +21,12 @@ uint8_t pp_u8(PayloadParser *pp)
 
 uint16_t pp_u16(PayloadParser *pp)
 {
-    pp_check_capacity(pp, 2);
-    if (!pp->ok) return 0;
-
-    uint16_t x = 0;
-
-    if (pp->bigendian) {
-        x |= *pp->current++ << 8;
-        x |= *pp->current++;
-    } else {
-        x |= *pp->current++;
-        x |= *pp->current++ << 8;
-    }
-    return x;
+    return pp->bigendian ? pp_be_u16(pp) : pp_le_u16(pp);
 }
 
 uint32_t pp_u32(PayloadParser *pp)
 {
-    pp_check_capacity(pp, 4);
-    if (!pp->ok) return 0;
-
-    uint32_t x = 0;
-
-    if (pp->bigendian) {
-        x |= (uint32_t) (*pp->current++ << 24);
-        x |= (uint32_t) (*pp->current++ << 16);
-        x |= (uint32_t) (*pp->current++ << 8);
-        x |= *pp->current++;
-    } else {
-        x |= *pp->current++;
-        x |= (uint32_t) (*pp->current++ << 8);
-        x |= (uint32_t) (*pp->current++ << 16);
-        x |= (uint32_t) (*pp->current++ << 24);
-    }
-    return x;
+    return pp->bigendian ? pp_be_u32(pp) : pp_le_u32(pp);
 }
 
 const uint8_t *pp_tail(PayloadParser *pp, uint32_t *length)
@@ -95,12 +68,89 @@ float pp_float(PayloadParser *pp)
     return ((union conv32) {.u32 = pp_u32(pp)}).f32;
 }
 
+/** Ask the empty handler for more data, if there is one. Does not affect the ok flag. */
+static inline bool pp_refill(PayloadParser *pp)
+{
+    return pp->empty_handler != NULL && pp->empty_handler(pp, 1);
+}
+
+/** Read uint64_t from the payload. */
+uint64_t pp_u64(PayloadParser *pp)
+{
+    uint64_t x;
+
+    pp_check_capacity(pp, 8);
+    if (!pp->ok) return 0;
+
+    if (pp->bigendian) {
+        x = (uint64_t) pp_be_u32(pp) << 32;
+        x |= pp_be_u32(pp);
+    } else {
+        x = pp_le_u32(pp);
+        x |= (uint64_t) pp_le_u32(pp) << 32;
+    }
+    return x;
+}
+
+/** Read int64_t from the payload. */
+int64_t pp_i64(PayloadParser *pp)
+{
+    return ((union conv64) {.u64 = pp_u64(pp)}).i64;
+}
+
+/** Read 8-byte double from the payload. */
+double pp_double(PayloadParser *pp)
+{
+    return ((union conv64) {.u64 = pp_u64(pp)}).f64;
+}
+
+/** Read an unsigned varint */
+uint64_t pp_varint(PayloadParser *pp)
+{
+    uint64_t x = 0;
+    uint8_t b;
+    int shift;
+
+    // Fast path for the common 1 and 2 byte varints
+    if (pp->ok && pp->current + 2 <= pp->end) {
+        b = pp->current[0];
+        if (!(b & 0x80)) {
+            pp->current += 1;
+            return b;
+        }
+        if (!(pp->current[1] & 0x80)) {
+            x = (uint64_t) (b & 0x7F) | ((uint64_t) pp->current[1] << 7);
+            pp->current += 2;
+            return x;
+        }
+    }
+
+    for (shift = 0; shift < 64; shift += 7) {
+        b = pp_u8(pp);
+        if (!pp->ok) return 0;
+
+        x |= (uint64_t) (b & 0x7F) << shift;
+        if (!(b & 0x80)) return x;
+    }
+
+    // Too long
+    pp->ok = 0;
+    return 0;
+}
+
+/** Read a signed (zigzag) varint */
+int64_t pp_svarint(PayloadParser *pp)
+{
+    return tc_zigzag_dec(pp_varint(pp));
+}
+
 /** Read a zstring */
 uint32_t pp_string(PayloadParser *pp, char *buffer, uint32_t maxlen)
 {
     pp_check_capacity(pp, 1);
     uint32_t len = 0;
-    while (len < maxlen-1 && pp->current != pp->end) {
+    while (len < maxlen-1) {
+        if (pp->current == pp->end && !pp_refill(pp)) break;
         char c = *buffer++ = *pp->current++;
         if (c == 0) break;
         len++;
@@ -113,9 +163,140 @@ uint32_t pp_string(PayloadParser *pp, char *buffer, uint32_t maxlen)
 uint32_t pp_buf(PayloadParser *pp, uint8_t *buffer, uint32_t maxlen)
 {
     uint32_t len = 0;
-    while (len < maxlen && pp->current != pp->end) {
-        *buffer++ = *pp->current++;
-        len++;
+    uint32_t chunk;
+    while (len < maxlen) {
+        if (pp->current == pp->end && !pp_refill(pp)) break;
+        chunk = (uint32_t) (pp->end - pp->current);
+        if (chunk > maxlen - len) chunk = maxlen - len;
+        memcpy(buffer, pp->current, chunk);
+        buffer += chunk;
+        pp->current += chunk;
+        len += chunk;
     }
     return len;
 }
+
+/** Get a pointer to bytes in the payload, skipping them */
+const uint8_t *pp_view(PayloadParser *pp, uint32_t len)
+{
+    if (!pp_ensure(pp, len)) return NULL;
+    pp->current += len;
+    return pp->current - len;
+}
+
+/** Get a pointer to a zero-terminated string in the payload, skipping it */
+const char *pp_string_view(PayloadParser *pp, uint32_t *length)
+{
+    const uint8_t *s = pp->current;
+    const uint8_t *term;
+
+    if (length != NULL) *length = 0;
+    if (!pp->ok) return NULL;
+
+    term = memchr(s, 0, (size_t) (pp->end - s));
+    if (term == NULL) {
+        pp->ok = 0;
+        return NULL;
+    }
+
+    pp->current = term + 1;
+    if (length != NULL) *length = (uint32_t) (term - s);
+    return (const char *) s;
+}
+
+/**
+ * Read an array of 2- or 4-byte numbers. The bounds are checked once for each
+ * contiguous piece of the input (just once, unless an empty handler refills it).
+ */
+static bool pp_array(PayloadParser *pp, void *out, uint32_t count, uint32_t size)
+{
+    uint8_t *dest = out;
+    uint32_t n;
+
+    while (count > 0) {
+        // With an empty handler, the array can be read in pieces
+        pp_check_capacity(pp, pp->empty_handler ? size : count * size);
+        if (!pp->ok) return false;
+
+        n = (uint32_t) (pp->end - pp->current) / size;
+        if (n > count) n = count;
+        if (n == 0) {
+            // The handler loaded less than one item
+            pp->ok = 0;
+            return false;
+        }
+
+#if TC_HOST_ENDIAN_KNOWN
+        memcpy(dest, pp->current, n * size);
+        if (pp->bigendian != TC_HOST_BIGENDIAN) {
+            if (size == 2) tc_bswap16_array(dest, n);
+            else tc_bswap32_array(dest, n);
+        }
+        pp->current += n * size;
+#else
+        uint32_t i;
+        for (i = 0; i < n; i++) {
+            if (size == 2) ((uint16_t *) dest)[i] = pp_u16(pp);
+            else ((uint32_t *) dest)[i] = pp_u32(pp);
+        }
+#endif
+        dest += n * size;
+        count -= n;
+    }
+    return true;
+}
+
+/** Read an array of uint16_t */
+bool pp_u16_array(PayloadParser *pp, uint16_t *out, uint32_t count)
+{
+    return pp_array(pp, out, count, 2);
+}
+
+/** Read an array of uint32_t */
+bool pp_u32_array(PayloadParser *pp, uint32_t *out, uint32_t count)
+{
+    return pp_array(pp, out, count, 4);
+}
+
+/** Read an array of 4-byte floats */
+bool pp_float_array(PayloadParser *pp, float *out, uint32_t count)
+{
+    return pp_array(pp, out, count, 4);
+}
+
+/** Continue in the next piece of the data, joining a value split between pieces in the carry */
+bool pp_refill_from(PayloadParser *pp, uint32_t needed, uint8_t *carry, uint32_t carry_size,
+                    pp_piece_source next, void *source)
+{
+    uint32_t have = (uint32_t) pp_length(pp);
+    const uint8_t *piece;
+    uint32_t len;
+
+    if (have == 0) {
+        // Read the next piece in place if the value fits in it
+        piece = next(source, UINT32_MAX, &len);
+        if (piece == NULL) return false;
+
+        pp->start = pp->current = piece;
+        pp->end = piece + len;
+        if (len >= needed) return true;
+        have = len;
+    }
+
+    if (needed > carry_size) return false;
+
+    // Join the rest of the piece with the start of the following ones.
+    // The old piece may be overwritten when the next one is read.
+    memmove(carry, pp->current, have);
+    while (have < needed) {
+        piece = next(source, needed - have, &len);
+        if (piece == NULL || len == 0) return false;
+
+        memcpy(carry + have, piece, len);
+        have += len;
+    }
+
+    pp->start = pp->current = carry;
+    pp->end = carry + have;
+    return true;
+}
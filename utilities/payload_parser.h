@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <assert.h>
 #include "type_coerce.h"
 
 typedef struct PayloadParser_ PayloadParser;
@@ -47,12 +48,13 @@ struct PayloadParser_ {
     pp_empty_handler empty_handler; //!< Callback for buffer underrun
     bool bigendian;   //!< Flag to use big-endian parsing
     bool ok;          //!< Indicates that all reads were successful
+    void *userdata;   //!< Custom user data for the empty_handler
 };
 
 // --- initializer helper macros ---
 
 /** Start the parser. */
-#define pp_start_e(buf, length, bigendian, empty_handler) ((PayloadParser){buf, buf, (buf)+(length), empty_handler, bigendian, 1})
+#define pp_start_e(buf, length, bigendian, empty_handler) ((PayloadParser){buf, buf, (buf)+(length), empty_handler, bigendian, 1, NULL})
 
 /** Start the parser in big-endian mode */
 #define pp_start_be(buf, length, empty_handler) pp_start_e(buf, length, 1, empty_handler)
@@ -119,6 +121,24 @@ int32_t pp_i32(PayloadParser *pp);
 /** Read 4-byte float from the payload. */
 float pp_float(PayloadParser *pp);
 
+/** Read uint64_t from the payload. */
+uint64_t pp_u64(PayloadParser *pp);
+
+/** Read int64_t from the payload. */
+int64_t pp_i64(PayloadParser *pp);
+
+/** Read 8-byte double from the payload. */
+double pp_double(PayloadParser *pp);
+
+/**
+ * Read an unsigned LEB128 varint (7 bits per byte, low bits first).
+ * Malformed varints (longer than 10 bytes) clear the ok flag.
+ */
+uint64_t pp_varint(PayloadParser *pp);
+
+/** Read a zigzag-encoded signed varint. */
+int64_t pp_svarint(PayloadParser *pp);
+
 /**
  * Parse a zero-terminated string
  *
@@ -132,6 +152,9 @@ uint32_t pp_string(PayloadParser *pp, char *buffer, uint32_t maxlen);
 /**
  * Parse a buffer
  *
+ * If the end of data is reached, the empty handler is asked for more
+ * (with needed = 1) before giving up.
+ *
  * @param pp - parser
  * @param buffer - target buffer
  * @param maxlen - buffer size
@@ -139,5 +162,314 @@ uint32_t pp_string(PayloadParser *pp, char *buffer, uint32_t maxlen);
  */
 uint32_t pp_buf(PayloadParser *pp, uint8_t *buffer, uint32_t maxlen);
 
+// --- zero-copy views ---
+// Those return pointers into the parsed buffer instead of copying the bytes out.
+// The pointers are valid as long as the buffer is (e.g. until the listener returns).
+// With an empty handler, the view must be within the currently loaded part
+// of the payload (the handler may be asked to load it, as with other reads).
+
+/**
+ * Get a view of 'len' bytes of the payload (a blob), and skip them.
+ *
+ * @param pp - parser
+ * @param len - number of bytes
+ * @return pointer to the bytes, NULL if there's not enough data (pp->ok is then cleared)
+ */
+const uint8_t *pp_view(PayloadParser *pp, uint32_t len);
+
+/**
+ * Get a view of a zero-terminated string in the payload, and skip it.
+ *
+ * @param pp - parser
+ * @param length - here the string length (excluding terminator) is stored, can be NULL
+ * @return the string, NULL if it's not terminated before the end of data (pp->ok is then cleared)
+ */
+const char *pp_string_view(PayloadParser *pp, uint32_t *length);
+
+/**
+ * Read an array of uint16_t
+ *
+ * This is much faster than reading the elements one by one - the bounds
+ * are checked once and the data copied in bulk, swapping bytes if needed.
+ *
+ * @param pp - parser
+ * @param out - target array
+ * @param count - number of elements to read
+ * @return success (false if the payload ended, pp->ok is then cleared)
+ */
+bool pp_u16_array(PayloadParser *pp, uint16_t *out, uint32_t count);
+
+/** Read an array of uint32_t, see pp_u16_array() */
+bool pp_u32_array(PayloadParser *pp, uint32_t *out, uint32_t count);
+
+/** Read an array of 4-byte floats, see pp_u16_array() */
+bool pp_float_array(PayloadParser *pp, float *out, uint32_t count);
+
+// --- endian-specific inline readers ---
+// Those don't check the bigendian flag and are inlined, so the compiler can
+// turn them into plain loads and merge the bounds checks of consecutive reads.
+
+/** Check that 'needed' bytes can be read, calling the empty handler if not. */
+static inline bool pp_ensure(PayloadParser *pp, uint32_t needed)
+{
+    if (pp->current + needed > pp->end) {
+        if (pp->empty_handler == NULL || !pp->empty_handler(pp, needed)) pp->ok = 0;
+    }
+    return pp->ok;
+}
+
+/** Read little-endian uint16_t */
+static inline uint16_t pp_le_u16(PayloadParser *pp)
+{
+    if (!pp_ensure(pp, 2)) return 0;
+    pp->current += 2;
+    return tc_load_le16(pp->current - 2);
+}
+
+/** Read big-endian uint16_t */
+static inline uint16_t pp_be_u16(PayloadParser *pp)
+{
+    if (!pp_ensure(pp, 2)) return 0;
+    pp->current += 2;
+    return tc_load_be16(pp->current - 2);
+}
+
+/** Read little-endian uint32_t */
+static inline uint32_t pp_le_u32(PayloadParser *pp)
+{
+    if (!pp_ensure(pp, 4)) return 0;
+    pp->current += 4;
+    return tc_load_le32(pp->current - 4);
+}
+
+/** Read big-endian uint32_t */
+static inline uint32_t pp_be_u32(PayloadParser *pp)
+{
+    if (!pp_ensure(pp, 4)) return 0;
+    pp->current += 4;
+    return tc_load_be32(pp->current - 4);
+}
+
+/** Read little-endian int16_t */
+static inline int16_t pp_le_i16(PayloadParser *pp)
+{
+    return ((union conv16) {.u16 = pp_le_u16(pp)}).i16;
+}
+
+/** Read big-endian int16_t */
+static inline int16_t pp_be_i16(PayloadParser *pp)
+{
+    return ((union conv16) {.u16 = pp_be_u16(pp)}).i16;
+}
+
+/** Read little-endian int32_t */
+static inline int32_t pp_le_i32(PayloadParser *pp)
+{
+    return ((union conv32) {.u32 = pp_le_u32(pp)}).i32;
+}
+
+/** Read big-endian int32_t */
+static inline int32_t pp_be_i32(PayloadParser *pp)
+{
+    return ((union conv32) {.u32 = pp_be_u32(pp)}).i32;
+}
+
+/** Read little-endian 4-byte float */
+static inline float pp_le_float(PayloadParser *pp)
+{
+    return ((union conv32) {.u32 = pp_le_u32(pp)}).f32;
+}
+
+/** Read big-endian 4-byte float */
+static inline float pp_be_float(PayloadParser *pp)
+{
+    return ((union conv32) {.u32 = pp_be_u32(pp)}).f32;
+}
+
+// --- data split into pieces ---
+
+/**
+ * Source of data split into pieces (segments, chunks of a stream).
+ *
+ * Return the next piece of at most 'max' bytes and store its length in 'len',
+ * or return NULL if the data ended.
+ */
+typedef const uint8_t *(*pp_piece_source)(void *source, uint32_t max, uint32_t *len);
+
+/**
+ * Helper for empty handlers reading data split into pieces.
+ *
+ * If the parser's buffer is used up and the next piece holds the needed bytes,
+ * the parser reads it in place. Otherwise the rest of the buffer is joined with
+ * the start of the following pieces in 'carry' (up to 'carry_size' bytes).
+ *
+ * @param pp - the parser
+ * @param needed - bytes needed, as given to the empty handler
+ * @param carry - buffer for values split between pieces
+ * @param carry_size - size of the carry buffer
+ * @param next - source of the pieces
+ * @param source - its argument
+ * @return success, false if the data ended or the value doesn't fit in the carry
+ */
+bool pp_refill_from(PayloadParser *pp, uint32_t needed, uint8_t *carry, uint32_t carry_size,
+                    pp_piece_source next, void *source);
+
+// --- unchecked readers ---
+// For fixed-layout data, check the length once with pp_require() and then read
+// the fields with the pp_raw_* functions. Those do no bounds checking and compile
+// to plain loads. Debug builds (without NDEBUG) still assert that the reads are
+// within the buffer.
+
+#ifndef NDEBUG
+#define pp_raw_check(pp, n) assert((pp)->ok && (pp)->current + (n) <= (pp)->end)
+#else
+#define pp_raw_check(pp, n) ((void) 0)
+#endif
+
+/**
+ * Check that at least 'n' bytes can be read, calling the empty handler if not.
+ * If it succeeds, up to 'n' bytes can be read using the pp_raw_* functions.
+ *
+ * @param pp - parser
+ * @param n - number of bytes to be read
+ * @return success; pp->ok is cleared if there's not enough data
+ */
+static inline bool pp_require(PayloadParser *pp, uint32_t n)
+{
+    return pp_ensure(pp, n);
+}
+
+/** Read uint8_t, unchecked */
+static inline uint8_t pp_raw_u8(PayloadParser *pp)
+{
+    pp_raw_check(pp, 1);
+    return *pp->current++;
+}
+
+/** Read int8_t, unchecked */
+static inline int8_t pp_raw_i8(PayloadParser *pp)
+{
+    return ((union conv8) {.u8 = pp_raw_u8(pp)}).i8;
+}
+
+/** Read bool, unchecked */
+static inline bool pp_raw_bool(PayloadParser *pp)
+{
+    return pp_raw_u8(pp) != 0;
+}
+
+/** Read little-endian uint16_t, unchecked */
+static inline uint16_t pp_raw_le_u16(PayloadParser *pp)
+{
+    pp_raw_check(pp, 2);
+    pp->current += 2;
+    return tc_load_le16(pp->current - 2);
+}
+
+/** Read big-endian uint16_t, unchecked */
+static inline uint16_t pp_raw_be_u16(PayloadParser *pp)
+{
+    pp_raw_check(pp, 2);
+    pp->current += 2;
+    return tc_load_be16(pp->current - 2);
+}
+
+/** Read little-endian uint32_t, unchecked */
+static inline uint32_t pp_raw_le_u32(PayloadParser *pp)
+{
+    pp_raw_check(pp, 4);
+    pp->current += 4;
+    return tc_load_le32(pp->current - 4);
+}
+
+/** Read big-endian uint32_t, unchecked */
+static inline uint32_t pp_raw_be_u32(PayloadParser *pp)
+{
+    pp_raw_check(pp, 4);
+    pp->current += 4;
+    return tc_load_be32(pp->current - 4);
+}
+
+/** Read little-endian uint64_t, unchecked */
+static inline uint64_t pp_raw_le_u64(PayloadParser *pp)
+{
+    uint64_t x = pp_raw_le_u32(pp);
+    return x | ((uint64_t) pp_raw_le_u32(pp) << 32);
+}
+
+/** Read big-endian uint64_t, unchecked */
+static inline uint64_t pp_raw_be_u64(PayloadParser *pp)
+{
+    uint64_t x = (uint64_t) pp_raw_be_u32(pp) << 32;
+    return x | pp_raw_be_u32(pp);
+}
+
+/** Read little-endian int16_t, unchecked */
+static inline int16_t pp_raw_le_i16(PayloadParser *pp)
+{
+    return ((union conv16) {.u16 = pp_raw_le_u16(pp)}).i16;
+}
+
+/** Read big-endian int16_t, unchecked */
+static inline int16_t pp_raw_be_i16(PayloadParser *pp)
+{
+    return ((union conv16) {.u16 = pp_raw_be_u16(pp)}).i16;
+}
+
+/** Read little-endian int32_t, unchecked */
+static inline int32_t pp_raw_le_i32(PayloadParser *pp)
+{
+    return ((union conv32) {.u32 = pp_raw_le_u32(pp)}).i32;
+}
+
+/** Read big-endian int32_t, unchecked */
+static inline int32_t pp_raw_be_i32(PayloadParser *pp)
+{
+    return ((union conv32) {.u32 = pp_raw_be_u32(pp)}).i32;
+}
+
+/** Read little-endian int64_t, unchecked */
+static inline int64_t pp_raw_le_i64(PayloadParser *pp)
+{
+    return ((union conv64) {.u64 = pp_raw_le_u64(pp)}).i64;
+}
+
+/** Read big-endian int64_t, unchecked */
+static inline int64_t pp_raw_be_i64(PayloadParser *pp)
+{
+    return ((union conv64) {.u64 = pp_raw_be_u64(pp)}).i64;
+}
+
+/** Read little-endian 4-byte float, unchecked */
+static inline float pp_raw_le_float(PayloadParser *pp)
+{
+    return ((union conv32) {.u32 = pp_raw_le_u32(pp)}).f32;
+}
+
+/** Read big-endian 4-byte float, unchecked */
+static inline float pp_raw_be_float(PayloadParser *pp)
+{
+    return ((union conv32) {.u32 = pp_raw_be_u32(pp)}).f32;
+}
+
+/** Read little-endian 8-byte double, unchecked */
+static inline double pp_raw_le_double(PayloadParser *pp)
+{
+    return ((union conv64) {.u64 = pp_raw_le_u64(pp)}).f64;
+}
+
+/** Read big-endian 8-byte double, unchecked */
+static inline double pp_raw_be_double(PayloadParser *pp)
+{
+    return ((union conv64) {.u64 = pp_raw_be_u64(pp)}).f64;
+}
+
+/** Copy bytes, unchecked */
+static inline void pp_raw_buf(PayloadParser *pp, uint8_t *buffer, uint32_t len)
+{
+    pp_raw_check(pp, len);
+    memcpy(buffer, pp->current, len);
+    pp->current += len;
+}
 
 #endif // PAYLOAD_PARSER_H
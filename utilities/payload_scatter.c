@@ -0,0 +1,67 @@
+#include "payload_scatter.h"
+
+/** Find the next segment with unread bytes */
+static bool pp_scatter_next(PayloadScatter *ps)
+{
+    while (ps->seg < ps->iovcnt && ps->off >= ps->iov[ps->seg].len) {
+        ps->seg++;
+        ps->off = 0;
+    }
+    return ps->seg < ps->iovcnt;
+}
+
+/** Give the unread part of the next segment, at most max bytes */
+static const uint8_t *pp_scatter_piece(void *source, uint32_t max, uint32_t *len)
+{
+    PayloadScatter *ps = source;
+    const pp_iovec *seg;
+    const uint8_t *piece;
+
+    if (!pp_scatter_next(ps)) return NULL;
+
+    seg = &ps->iov[ps->seg];
+    piece = seg->base + ps->off;
+    *len = seg->len - ps->off;
+    if (*len > max) *len = max;
+    ps->off += *len;
+    return piece;
+}
+
+/** Empty handler - continue in the next segment */
+static bool pp_scatter_refill(PayloadParser *pp, uint32_t needed)
+{
+    PayloadScatter *ps = pp->userdata;
+    return pp_refill_from(pp, needed, ps->carry, PP_SCATTER_CARRY, pp_scatter_piece, ps);
+}
+
+PayloadParser *pp_start_scatter(PayloadScatter *ps, const pp_iovec *iov, uint32_t iovcnt, bool bigendian)
+{
+    ps->iov = iov;
+    ps->iovcnt = iovcnt;
+    ps->seg = 0;
+    ps->off = 0;
+
+    // Start in the first segment right away, the handler is called only at its end
+    if (iovcnt > 0) {
+        ps->pp = pp_start_e(iov[0].base, iov[0].len, bigendian, pp_scatter_refill);
+        ps->off = iov[0].len;
+    } else {
+        ps->pp = pp_start_e(ps->carry, 0, bigendian, pp_scatter_refill);
+    }
+    ps->pp.userdata = ps;
+    return &ps->pp;
+}
+
+uint32_t pp_scatter_remaining(const PayloadScatter *ps)
+{
+    uint32_t n = (uint32_t) pp_length(&ps->pp);
+    uint32_t i;
+
+    if (ps->seg < ps->iovcnt) {
+        n += ps->iov[ps->seg].len - ps->off;
+        for (i = ps->seg + 1; i < ps->iovcnt; i++) {
+            n += ps->iov[i].len;
+        }
+    }
+    return n;
+}
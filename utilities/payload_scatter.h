@@ -0,0 +1,60 @@
+#ifndef PAYLOAD_SCATTER_H
+#define PAYLOAD_SCATTER_H
+
+/**
+ * PayloadScatter, part of the TinyFrame utilities collection
+ *
+ * (c) Ondřej Hruška, 2018. MIT license.
+ *
+ * A PayloadParser reading data split into several buffers (segments),
+ * e.g. the two parts of a wrapped-around ring buffer or a chain of network
+ * buffers, without copying them into one buffer first.
+ *
+ * Reads within a segment are done in place, just like with a plain parser.
+ * When the end of a segment is reached, the parser's empty handler moves on
+ * to the next one; a value split between two segments is joined in a small
+ * carry buffer.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "payload_parser.h"
+
+/** Size of the buffer joining values split between segments */
+#define PP_SCATTER_CARRY 8
+
+/** One segment of the data */
+typedef struct {
+    const uint8_t *base; //!< Segment data
+    uint32_t len;        //!< Segment length
+} pp_iovec;
+
+/** PayloadParser reading a list of segments */
+typedef struct {
+    PayloadParser pp;       //!< The parser, use with the pp_* functions
+    const pp_iovec *iov;    //!< The segments
+    uint32_t iovcnt;        //!< Number of segments
+    uint32_t seg;           //!< Index of the segment being read
+    uint32_t off;           //!< Offset of the first byte of the segment not given to the parser
+    uint8_t carry[PP_SCATTER_CARRY]; //!< Values split between segments are joined here
+} PayloadScatter;
+
+/**
+ * Set up a parser over a list of segments.
+ *
+ * The segment list must stay valid while parsing. pp_length() gives only
+ * the length of the current segment (see pp_scatter_remaining()), and
+ * pp_skip(), pp_view() and pp_string_view() work only within a segment.
+ *
+ * @param ps - scatter parser struct to initialize
+ * @param iov - the segments
+ * @param iovcnt - number of segments
+ * @param bigendian - use big-endian decoding
+ * @return the parser
+ */
+PayloadParser *pp_start_scatter(PayloadScatter *ps, const pp_iovec *iov, uint32_t iovcnt, bool bigendian);
+
+/** Get the number of bytes left in all the segments */
+uint32_t pp_scatter_remaining(const PayloadScatter *ps);
+
+#endif // PAYLOAD_SCATTER_H
@@ -0,0 +1,146 @@
+#include "tf_payload.h"
+
+/** Full handler for frames with a known length - commit the written bytes and flush */
+static bool tf_pb_flush(PayloadBuilder *pb, uint32_t needed)
+{
+    TinyFrame *tf = pb->userdata;
+    uint32_t length = (uint32_t) pb_length(pb);
+    uint32_t remain;
+    uint32_t avail;
+    uint8_t *buf;
+
+    TF_Multipart_Commit(tf, length);
+    pb->flushed += length;
+    pb->start = pb->current = pb->end = NULL;
+
+    // Don't write past the length announced in the head
+    remain = tf->tx_len - pb->flushed;
+    if (needed > remain) {
+        if (pb->ok) {
+            TF_Error("Payload longer than the announced %d bytes", (int) tf->tx_len);
+        }
+        return false;
+    }
+
+    buf = TF_Multipart_Buffer(tf, needed, &avail);
+    if (buf == NULL) {
+        return false;
+    }
+
+    pb->start = pb->current = buf;
+    pb->end = buf + (avail < remain ? avail : remain);
+    return true;
+}
+
+/** Full handler for frames with unknown length - the head must stay in the buffer */
+static bool tf_pb_overflow(PayloadBuilder *pb, uint32_t needed)
+{
+    if (pb->ok) {
+        TF_Error("Payload doesn't fit in the Tx buffer, %d more bytes needed", (int)needed);
+    }
+    return false;
+}
+
+bool TF_Send_Builder(TinyFrame *tf, TF_Msg *msg, PayloadBuilder *pb, bool bigendian)
+{
+    uint32_t avail;
+    uint8_t *buf;
+    bool sized = (msg->len != 0);
+
+    // The head is composed with a placeholder length, fixed when closing the frame
+    if (!sized) msg->len = 1;
+    if (!TF_Send_Multipart(tf, msg)) {
+        if (!sized) msg->len = 0;
+        return false;
+    }
+    if (!sized) msg->len = 0;
+
+    buf = TF_Multipart_Buffer(tf, 0, &avail);
+    if (sized && avail > msg->len) avail = msg->len;
+    *pb = pb_start_e(buf, avail, bigendian, sized ? tf_pb_flush : tf_pb_overflow);
+    pb->userdata = tf;
+    return true;
+}
+
+bool TF_Builder_Close(TinyFrame *tf, PayloadBuilder *pb)
+{
+    if (pb->full_handler == tf_pb_overflow) {
+        if (!pb->ok) {
+            TF_Multipart_Abort(tf);
+            return false;
+        }
+
+        if ((uint32_t) (TF_LEN) pb_length(pb) != (uint32_t) pb_length(pb)) {
+            TF_Error("Payload too long, %d bytes", (int) pb_length(pb));
+            TF_Multipart_Abort(tf);
+            return false;
+        }
+
+        // Nothing was flushed, so the payload is still in one piece
+        TF_Multipart_SetLength(tf, (TF_LEN) pb_length(pb));
+    }
+    else if (pb->ok && pb->flushed + (uint32_t) pb_length(pb) != tf->tx_len) {
+        TF_Error("Payload has %d bytes, %d were announced",
+                 (int) (pb->flushed + pb_length(pb)), (int) tf->tx_len);
+        pb->ok = false;
+    }
+
+    if (pb->current != NULL) {
+        TF_Multipart_Commit(tf, (uint32_t) pb_length(pb));
+    }
+
+    // Drop the broken frame, unless a part of it is already out
+    if (!pb->ok && !tf->tx_flushed) {
+        TF_Multipart_Abort(tf);
+        return false;
+    }
+
+    TF_Multipart_Close(tf);
+    return pb->ok;
+}
+
+bool TF_Send_Chain(TinyFrame *tf, TF_Msg *msg, PayloadChain *pc)
+{
+    PayloadChunk *c;
+    uint32_t len = pa_length(pc);
+
+    if (!pc->pb.ok) return false;
+    if ((uint32_t) (TF_LEN) len != len) {
+        TF_Error("Payload too long, %d bytes", (int)len);
+        return false;
+    }
+
+    msg->len = (TF_LEN) len;
+    if (!TF_Send_Multipart(tf, msg)) return false;
+
+    for (c = pa_chunks(pc); c != NULL; c = c->next) {
+        TF_Multipart_Payload(tf, c->data, c->len);
+    }
+    TF_Multipart_Close(tf);
+    return true;
+}
+
+#if TF_USE_STREAM_RX
+
+/** Read the next payload chunk of the frame being received */
+static const uint8_t *tf_pp_chunk(void *source, uint32_t max, uint32_t *len)
+{
+    return TF_StreamChunk(source, max, len);
+}
+
+/** Empty handler of the stream parser - load the next payload chunk */
+static bool tf_pp_refill(PayloadParser *pp, uint32_t needed)
+{
+    TF_PayloadStream *st = pp->userdata;
+    return pp_refill_from(pp, needed, st->carry, TF_STREAM_CARRY, tf_pp_chunk, st->tf);
+}
+
+PayloadParser *TF_StreamParser(TF_PayloadStream *st, TinyFrame *tf, bool bigendian)
+{
+    st->tf = tf;
+    st->pp = pp_start_e(st->carry, 0, bigendian, tf_pp_refill);
+    st->pp.userdata = st;
+    return &st->pp;
+}
+
+#endif
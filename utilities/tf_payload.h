@@ -0,0 +1,110 @@
+#ifndef TF_PAYLOAD_H
+#define TF_PAYLOAD_H
+
+/**
+ * TinyFrame integration of PayloadBuilder and PayloadParser,
+ * part of the TinyFrame utilities collection
+ *
+ * (c) Ondřej Hruška, 2018. MIT license.
+ *
+ * The builder functions let you serialize a structured payload straight
+ * into the TinyFrame Tx buffer; it's sent as a multipart frame and flushed
+ * whenever the buffer fills up, so no intermediate buffer is needed.
+ *
+ * Payloads built in an arena (PayloadArena) are sent chunk by chunk,
+ * without joining them first.
+ *
+ * The stream parser lets a stream listener (TF_USE_STREAM_RX) decode
+ * a payload while it's being received, pulling it chunk by chunk.
+ */
+
+#include "TinyFrame.h"
+#include "payload_builder.h"
+#include "payload_parser.h"
+#include "payload_arena.h"
+
+/**
+ * Start a multipart frame and set up a PayloadBuilder writing its payload.
+ *
+ * If msg->len is not zero, it's the payload length and the builder flushes
+ * the Tx buffer as needed. Exactly msg->len bytes must then be written; writes
+ * past the end fail and clear pb->ok, and TF_Builder_Close() fails if fewer
+ * bytes were written.
+ *
+ * If msg->len is 0, the length is not known in advance and the LEN field is
+ * filled in by TF_Builder_Close(). The whole frame must then fit in the Tx buffer
+ * (TF_SENDBUF_LEN); writes that don't fit fail and clear pb->ok.
+ *
+ * Set msg->is_response to send a response (see TF_Respond()).
+ *
+ * Caution: pb_length() gives only the length of the part not flushed yet
+ * (pb->flushed holds the rest), and a single write can't be larger than TF_SENDBUF_LEN (except for strings,
+ * buffers and arrays, which are written in pieces).
+ *
+ * @param tf - instance
+ * @param msg - message with the frame type (and length, if known)
+ * @param pb - builder to initialize
+ * @param bigendian - use big-endian encoding
+ * @return success
+ */
+bool TF_Send_Builder(TinyFrame *tf, TF_Msg *msg, PayloadBuilder *pb, bool bigendian);
+
+/**
+ * Close a frame started by TF_Send_Builder().
+ *
+ * If the payload didn't fit (pb->ok is false) or its length doesn't match
+ * the announced msg->len, this fails and the frame is discarded, unless
+ * it was partly flushed already.
+ *
+ * @param tf - instance
+ * @param pb - the builder
+ * @return success (pb->ok and the frame was sent)
+ */
+bool TF_Builder_Close(TinyFrame *tf, PayloadBuilder *pb);
+
+/**
+ * Send a payload built in an arena (see pa_start()) as a multipart frame,
+ * chunk by chunk. msg->len is set to the payload length.
+ *
+ * The chain is not released, call pa_release() when done with it.
+ *
+ * @param tf - instance
+ * @param msg - message with the frame type
+ * @param pc - the built payload
+ * @return success (false also if pc->pb.ok is false, nothing is sent then)
+ */
+bool TF_Send_Chain(TinyFrame *tf, TF_Msg *msg, PayloadChain *pc);
+
+#if TF_USE_STREAM_RX
+
+/** Size of the buffer joining values split between two payload chunks */
+#define TF_STREAM_CARRY 8
+
+/** PayloadParser reading a streamed payload */
+typedef struct {
+    PayloadParser pp;   //!< The parser, use with the pp_* functions
+    TinyFrame *tf;      //!< Instance receiving the frame
+    uint8_t carry[TF_STREAM_CARRY]; //!< Values split between chunks are joined here
+} TF_PayloadStream;
+
+/**
+ * Set up a PayloadParser over the payload of the frame being received.
+ * Use it in a stream listener (see TF_SetStreamListener()).
+ *
+ * The parser's empty handler pulls the next chunk using TF_StreamChunk(),
+ * so the pp_* functions can be used as if the whole payload was available.
+ * pp->ok is cleared if the payload ends or reading more of it fails.
+ *
+ * pp_length() gives only the length of the current chunk, and pp_skip()
+ * must not be used to skip past it.
+ *
+ * @param st - stream parser struct to initialize
+ * @param tf - instance
+ * @param bigendian - use big-endian decoding
+ * @return the parser
+ */
+PayloadParser *TF_StreamParser(TF_PayloadStream *st, TinyFrame *tf, bool bigendian);
+
+#endif
+
+#endif // TF_PAYLOAD_H
@@ -0,0 +1,649 @@
+#!/usr/bin/env python3
+"""
+TinyFrame schema compiler, part of the TinyFrame utilities collection
+
+(c) Ondřej Hruška, 2018. MIT license.
+
+Generates C encode/decode functions (usable from C++) for messages described
+in a small schema language. The generated code uses PayloadBuilder and
+PayloadParser, and TF_Send_Builder() from tf_payload.h for sending.
+
+Schema example:
+
+    # comments start with '#'
+    endian little;              # or 'big', default little
+
+    message Status = 0x11 {
+        u8 flags;
+        i16 temperature;
+        u32[4] counters;        # fixed size array
+        f32 voltage;
+        string name[16];        # zero terminated, buffer size 16
+        varint uptime;          # LEB128 varint (uint64_t)
+        svarint drift;          # zigzag varint (int64_t)
+    }
+
+Field types: u8 u16 u32 u64 i8 i16 i32 i64 f32 f64 bool varint svarint,
+arrays of those written as type[N] (except varints), and string[N].
+
+For each message, the generated header contains:
+
+    NAME_TYPE, NAME_SIZE  - frame type, payload size (fixed-size messages only)
+    NAME                  - struct with the fields
+    NAME_encode()         - write the message using a PayloadBuilder
+    NAME_decode()         - read the message using a PayloadParser
+    NAME_send()           - send the message as a frame
+    on_NAME()             - handler to be implemented by the user
+
+and <schema>_register() adds Type Listeners that decode the frames
+and call the handlers. Use --stubs to also generate empty handlers.
+
+In C++, NAMEView is a zero-copy view of a received payload; its accessors
+read the fields in place at fixed offsets, so there's no parsing pass.
+Only fields up to the first variable-size one (a string or varint,
+inclusive) have a fixed offset and are accessible from the view.
+
+Usage:
+    tf_schema.py messages.tfs [-o outdir] [--stubs]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+# name: (C type, size or None if variable, parser suffix, builder suffix)
+SCALARS = {
+    'u8':      ('uint8_t', 1, 'u8', 'u8'),
+    'i8':      ('int8_t', 1, 'i8', 'i8'),
+    'bool':    ('bool', 1, 'bool', 'bool'),
+    'u16':     ('uint16_t', 2, 'u16', 'u16'),
+    'i16':     ('int16_t', 2, 'i16', 'i16'),
+    'u32':     ('uint32_t', 4, 'u32', 'u32'),
+    'i32':     ('int32_t', 4, 'i32', 'i32'),
+    'f32':     ('float', 4, 'float', 'float'),
+    'u64':     ('uint64_t', 8, 'u64', 'u64'),
+    'i64':     ('int64_t', 8, 'i64', 'i64'),
+    'f64':     ('double', 8, 'double', 'double'),
+    'varint':  ('uint64_t', None, 'varint', 'varint'),
+    'svarint': ('int64_t', None, 'svarint', 'svarint'),
+}
+
+# Types with an endian-specific inline reader/writer (pp_le_u16 etc.)
+ENDIAN_INLINE = ('u16', 'i16', 'u32', 'i32', 'f32')
+
+# Array element types with a bulk reader/writer, and the function used
+BULK_ARRAYS = {
+    'u16': ('u16', 'uint16_t'),
+    'i16': ('u16', 'uint16_t'),
+    'u32': ('u32', 'uint32_t'),
+    'i32': ('u32', 'uint32_t'),
+    'f32': ('float', 'float'),
+}
+
+
+class SchemaError(Exception):
+    pass
+
+
+class Field:
+    def __init__(self, kind, name, count, line):
+        self.kind = kind    # scalar type name or 'string'
+        self.name = name
+        self.count = count  # array length / string buffer size, None for scalars
+        self.line = line
+
+    @property
+    def size(self):
+        """Encoded size, None if variable"""
+        if self.kind == 'string':
+            return None
+        size = SCALARS[self.kind][1]
+        if size is None:
+            return None
+        return size * (self.count or 1)
+
+
+class Message:
+    def __init__(self, name, type_id, line):
+        self.name = name
+        self.type_id = type_id
+        self.fields = []
+        self.line = line
+
+    @property
+    def size(self):
+        """Payload size, None if variable"""
+        total = 0
+        for f in self.fields:
+            if f.size is None:
+                return None
+            total += f.size
+        return total
+
+
+TOKEN_RE = re.compile(r'\s*(?:(#[^\n]*)|([A-Za-z_][A-Za-z0-9_]*)|(0x[0-9A-Fa-f]+|[0-9]+)|(.))')
+
+
+def tokenize(text):
+    """Yield (token, line) pairs"""
+    line = 1
+    last = 0
+    for m in TOKEN_RE.finditer(text):
+        comment, ident, number, other = m.groups()
+        tok = ident or number or other
+        if comment is not None or tok is None or tok.isspace():
+            continue
+        line += text.count('\n', last, m.start(m.lastindex))
+        last = m.start(m.lastindex)
+        yield tok, line
+
+
+class Parser:
+    def __init__(self, text):
+        self.tokens = list(tokenize(text))
+        self.pos = 0
+
+    def peek(self):
+        return self.tokens[self.pos][0] if self.pos < len(self.tokens) else None
+
+    def line(self):
+        if self.pos < len(self.tokens):
+            return self.tokens[self.pos][1]
+        return self.tokens[-1][1] if self.tokens else 1
+
+    def next(self):
+        if self.pos >= len(self.tokens):
+            raise SchemaError('unexpected end of schema')
+        tok = self.tokens[self.pos][0]
+        self.pos += 1
+        return tok
+
+    def expect(self, what):
+        line = self.line()
+        tok = self.next()
+        if tok != what:
+            raise SchemaError('line %d: expected "%s", got "%s"' % (line, what, tok))
+
+    def ident(self):
+        line = self.line()
+        tok = self.next()
+        if not re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', tok):
+            raise SchemaError('line %d: expected a name, got "%s"' % (line, tok))
+        return tok
+
+    def number(self):
+        line = self.line()
+        tok = self.next()
+        try:
+            return int(tok, 0)
+        except ValueError:
+            raise SchemaError('line %d: expected a number, got "%s"' % (line, tok))
+
+    def parse(self):
+        endian = 'little'
+        messages = []
+        while self.peek() is not None:
+            line = self.line()
+            kw = self.next()
+            if kw == 'endian':
+                endian = self.ident()
+                if endian not in ('little', 'big'):
+                    raise SchemaError('line %d: endian must be "little" or "big"' % line)
+                self.expect(';')
+            elif kw == 'message':
+                messages.append(self.message(line))
+            else:
+                raise SchemaError('line %d: unexpected "%s"' % (line, kw))
+        return endian, messages
+
+    def message(self, line):
+        msg = Message(self.ident(), None, line)
+        self.expect('=')
+        msg.type_id = self.number()
+        self.expect('{')
+        names = set()
+        while self.peek() != '}':
+            fline = self.line()
+            kind = self.ident()
+            count = None
+            if kind == 'string':
+                name = self.ident()
+                self.expect('[')
+                count = self.number()
+                self.expect(']')
+                if count < 1:
+                    raise SchemaError('line %d: string buffer must have at least 1 byte' % fline)
+            elif kind in SCALARS:
+                if self.peek() == '[':
+                    self.next()
+                    count = self.number()
+                    self.expect(']')
+                    if SCALARS[kind][1] is None:
+                        raise SchemaError('line %d: arrays of %s are not supported' % (fline, kind))
+                    if count < 1:
+                        raise SchemaError('line %d: array must have at least 1 element' % fline)
+                name = self.ident()
+            else:
+                raise SchemaError('line %d: unknown type "%s"' % (fline, kind))
+            self.expect(';')
+            if name in names:
+                raise SchemaError('line %d: duplicate field "%s"' % (fline, name))
+            names.add(name)
+            msg.fields.append(Field(kind, name, count, fline))
+        self.expect('}')
+        return msg
+
+
+def check(messages):
+    names = set()
+    types = {}
+    for m in messages:
+        if m.name in names:
+            raise SchemaError('line %d: duplicate message "%s"' % (m.line, m.name))
+        names.add(m.name)
+        if m.type_id in types:
+            raise SchemaError('line %d: message "%s" has the same type as "%s"'
+                              % (m.line, m.name, types[m.type_id]))
+        types[m.type_id] = m.name
+
+
+# --- code generation ---
+
+def struct_field(f):
+    if f.kind == 'string':
+        return 'char %s[%d];' % (f.name, f.count)
+    ctype = SCALARS[f.kind][0]
+    if f.count:
+        return '%s %s[%d];' % (ctype, f.name, f.count)
+    return '%s %s;' % (ctype, f.name)
+
+
+def encode_field(f, e):
+    """Lines writing field f; e is 'le' or 'be'"""
+    if f.kind == 'string':
+        return ['pb_buf(pb, (const uint8_t *) m->%s, tfs_strnlen(m->%s, %d));' % (f.name, f.name, f.count - 1),
+                'pb_u8(pb, 0);']
+    if f.count:
+        if f.kind in BULK_ARRAYS:
+            fn, ctype = BULK_ARRAYS[f.kind]
+            return ['pb_%s_array(pb, (const %s *) m->%s, %d);' % (fn, ctype, f.name, f.count)]
+        if f.kind == 'u8':
+            return ['pb_buf(pb, m->%s, %d);' % (f.name, f.count)]
+        return ['for (i = 0; i < %d; i++) pb_%s(pb, m->%s[i]);' % (f.count, SCALARS[f.kind][3], f.name)]
+    if f.kind in ENDIAN_INLINE:
+        return ['pb_%s_%s(pb, m->%s);' % (e, SCALARS[f.kind][3], f.name)]
+    return ['pb_%s(pb, m->%s);' % (SCALARS[f.kind][3], f.name)]
+
+
+def decode_field(f, e):
+    """Lines reading field f; e is 'le' or 'be'"""
+    if f.kind == 'string':
+        return ['tfs_string(pp, m->%s, %d);' % (f.name, f.count)]
+    if f.count:
+        if f.kind in BULK_ARRAYS:
+            fn, ctype = BULK_ARRAYS[f.kind]
+            return ['pp_%s_array(pp, (%s *) m->%s, %d);' % (fn, ctype, f.name, f.count)]
+        if f.kind == 'u8':
+            return ['pp_buf(pp, m->%s, %d);' % (f.name, f.count)]
+        return ['for (i = 0; i < %d; i++) m->%s[i] = pp_%s(pp);' % (f.count, f.name, SCALARS[f.kind][2])]
+    if f.kind in ENDIAN_INLINE:
+        return ['m->%s = pp_%s_%s(pp);' % (f.name, e, SCALARS[f.kind][2])]
+    return ['m->%s = pp_%s(pp);' % (f.name, SCALARS[f.kind][2])]
+
+
+def decode_field_raw(f, e):
+    """Lines reading field f without bounds checks (the length was checked before)"""
+    if f.count:
+        if f.kind in BULK_ARRAYS:
+            fn, ctype = BULK_ARRAYS[f.kind]
+            return ['pp_%s_array(pp, (%s *) m->%s, %d);' % (fn, ctype, f.name, f.count)]
+        if f.kind == 'u8':
+            return ['pp_raw_buf(pp, m->%s, %d);' % (f.name, f.count)]
+        return ['for (i = 0; i < %d; i++) m->%s[i] = %s;' % (f.count, f.name, raw_reader(f.kind, e))]
+    return ['m->%s = %s;' % (f.name, raw_reader(f.kind, e))]
+
+
+def raw_reader(kind, e):
+    if SCALARS[kind][1] == 1:
+        return 'pp_raw_%s(pp)' % SCALARS[kind][2]
+    return 'pp_raw_%s_%s(pp)' % (e, SCALARS[kind][2])
+
+
+def needs_loop_var(m):
+    return any(f.count and f.kind != 'string' and f.kind not in BULK_ARRAYS and f.kind != 'u8'
+               for f in m.fields)
+
+
+# Scalar accessor bodies for views: (return type, expression with %s for the offset)
+VIEW_LOADS = {
+    'u8':   ('uint8_t', 'data[%s]'),
+    'i8':   ('int8_t', 'bits<int8_t>(data[%s])'),
+    'bool': ('bool', 'data[%s] != 0'),
+    'u16':  ('uint16_t', 'load16(data + %s)'),
+    'i16':  ('int16_t', 'bits<int16_t>(load16(data + %s))'),
+    'u32':  ('uint32_t', 'load32(data + %s)'),
+    'i32':  ('int32_t', 'bits<int32_t>(load32(data + %s))'),
+    'f32':  ('float', 'bits<float>(load32(data + %s))'),
+    'u64':  ('uint64_t', 'load64(data + %s)'),
+    'i64':  ('int64_t', 'bits<int64_t>(load64(data + %s))'),
+    'f64':  ('double', 'bits<double>(load64(data + %s))'),
+}
+
+
+def view_fields(m):
+    """Fields accessible from a view, as (field, offset) pairs, and the fixed prefix size"""
+    fields = []
+    offset = 0
+    for f in m.fields:
+        fields.append((f, offset))
+        if f.size is None:
+            break
+        offset += f.size
+    return fields, offset
+
+
+def gen_view(w, m, e):
+    fields, prefix = view_fields(m)
+    name = m.name + 'View'
+    w('')
+    w('/** Zero-copy view of a received %s payload, fields are read in place */' % m.name)
+    w('struct %s {' % name)
+    w('    const uint8_t *data;')
+    w('    uint32_t len;')
+    w('')
+    w('    %s(const uint8_t *data, uint32_t len) : data(data), len(len) {}' % name)
+    w('    explicit %s(const TF_Msg *msg) : data(msg->data), len(msg->len) {}' % name)
+    w('')
+    w('    /** Check the payload is long enough for the accessors - call before using them */')
+    w('    bool valid() const { return len >= %d; }' % prefix)
+    for f, off in fields:
+        w('')
+        if f.kind == 'string':
+            w('    /** Zero-terminated string in the payload, NULL if not terminated */')
+            w('    const char *%s() const {' % f.name)
+            w('        const void *term = memchr(data + %d, 0, len - %d);' % (off, off))
+            w('        return term != NULL ? (const char *) (data + %d) : NULL;' % off)
+            w('    }')
+        elif f.kind in ('varint', 'svarint'):
+            w('    %s %s() const {' % (SCALARS[f.kind][0], f.name))
+            w('        PayloadParser pp = pp_start(data + %d, len - %d, NULL);' % (off, off))
+            w('        return pp_%s(&pp);' % f.kind)
+            w('    }')
+        elif f.count and f.kind == 'u8':
+            w('    const uint8_t *%s() const { return data + %d; }' % (f.name, off))
+            w('    static const uint32_t %s_count = %d;' % (f.name, f.count))
+        elif f.count:
+            rtype, expr = VIEW_LOADS[f.kind]
+            esize = SCALARS[f.kind][1]
+            w('    %s %s(uint32_t i) const { return %s; }'
+              % (rtype, f.name, expr % ('%d + i * %d' % (off, esize) if esize > 1 else '%d + i' % off)))
+            w('    static const uint32_t %s_count = %d;' % (f.name, f.count))
+        else:
+            rtype, expr = VIEW_LOADS[f.kind]
+            w('    %s %s() const { return %s; }' % (rtype, f.name, expr % off))
+    w('')
+    w('private:')
+    w('    template<typename T, typename U> static T bits(U u) { T t; memcpy(&t, &u, sizeof(t)); return t; }')
+    w('    static uint16_t load16(const uint8_t *p) { return tc_load_%s16(p); }' % e)
+    w('    static uint32_t load32(const uint8_t *p) { return tc_load_%s32(p); }' % e)
+    if e == 'be':
+        w('    static uint64_t load64(const uint8_t *p) { return ((uint64_t) load32(p) << 32) | load32(p + 4); }')
+    else:
+        w('    static uint64_t load64(const uint8_t *p) { return load32(p) | ((uint64_t) load32(p + 4) << 32); }')
+    w('};')
+
+
+def gen_header(base, endian, messages):
+    guard = re.sub(r'[^A-Za-z0-9]', '_', base).upper() + '_H'
+    out = []
+    w = out.append
+    w('// Generated by tf_schema.py from %s.tfs - do not edit' % base)
+    w('')
+    w('#ifndef %s' % guard)
+    w('#define %s' % guard)
+    w('')
+    w('#include <stdint.h>')
+    w('#include <stdbool.h>')
+    w('#include "TinyFrame.h"')
+    w('#include "payload_builder.h"')
+    w('#include "payload_parser.h"')
+    w('')
+    w('#ifdef __cplusplus')
+    w('extern "C" {')
+    w('#endif')
+    w('')
+    w('/** Byte order of multi-byte fields */')
+    w('#define %s_BIGENDIAN %d' % (base.upper(), 1 if endian == 'big' else 0))
+
+    for m in messages:
+        up = m.name.upper()
+        w('')
+        w('// --- %s ---' % m.name)
+        w('')
+        w('#define %s_TYPE 0x%02X' % (up, m.type_id))
+        if m.size is not None:
+            w('#define %s_SIZE %d' % (up, m.size))
+        w('')
+        w('typedef struct {')
+        for f in m.fields:
+            w('    ' + struct_field(f))
+        if not m.fields:
+            w('    uint8_t _empty; // unused')
+        w('} %s;' % m.name)
+        w('')
+        w('/** Write %s to a builder (sets pb->bigendian to the schema byte order) */' % m.name)
+        w('bool %s_encode(PayloadBuilder *pb, const %s *m);' % (m.name, m.name))
+        w('')
+        w('/** Read %s from a parser (sets pp->bigendian to the schema byte order) */' % m.name)
+        w('bool %s_decode(PayloadParser *pp, %s *m);' % (m.name, m.name))
+        w('')
+        w('/**')
+        w(' * Send %s as a frame.' % m.name)
+        w(' * msg can be NULL, or carry the frame ID (for responses) - type and len are set here.')
+        if m.size is None:
+            w(' * The encoded message must fit in the Tx buffer.')
+        w(' */')
+        w('bool %s_send(TinyFrame *tf, TF_Msg *msg, const %s *m);' % (m.name, m.name))
+        w('')
+        w('/** Handler for received %s frames - implement this in your application */' % m.name)
+        w('TF_Result on_%s(TinyFrame *tf, TF_Msg *msg, const %s *m);' % (m.name, m.name))
+
+    w('')
+    w('/** Add Type Listeners for all messages in the schema, calling the on_* handlers */')
+    w('bool %s_register(TinyFrame *tf);' % base)
+    w('')
+    w('#ifdef __cplusplus')
+    w('} // extern "C"')
+    w('')
+    w('#include <string.h>')
+    w('')
+    w('namespace %s {' % base)
+    w('')
+    w('/** Message traits, e.g. %s::traits<T>::type */' % base)
+    w('template<typename T> struct traits;')
+    for m in messages:
+        if m.fields:
+            gen_view(w, m, 'be' if endian == 'big' else 'le')
+        w('')
+        w('template<> struct traits<%s> {' % m.name)
+        w('    static const TF_TYPE type = %s_TYPE;' % m.name.upper())
+        if m.fields:
+            w('    typedef %sView view;' % m.name)
+        w('};')
+        w('inline bool encode(PayloadBuilder *pb, const %s &m) { return %s_encode(pb, &m); }' % (m.name, m.name))
+        w('inline bool decode(PayloadParser *pp, %s &m) { return %s_decode(pp, &m); }' % (m.name, m.name))
+        w('inline bool send(TinyFrame *tf, const %s &m, TF_Msg *msg = NULL) { return %s_send(tf, msg, &m); }'
+          % (m.name, m.name))
+    w('')
+    w('} // namespace %s' % base)
+    w('#endif')
+    w('')
+    w('#endif // %s' % guard)
+    return '\n'.join(out) + '\n'
+
+
+def gen_source(base, endian, messages):
+    e = 'be' if endian == 'big' else 'le'
+    bigendian = 'true' if endian == 'big' else 'false'
+    out = []
+    w = out.append
+    w('// Generated by tf_schema.py from %s.tfs - do not edit' % base)
+    w('')
+    w('#include "%s.h"' % base)
+    w('#include "tf_payload.h"')
+    w('')
+    w('/** Length of a string, at most max */')
+    w('static uint32_t tfs_strnlen(const char *s, uint32_t max)')
+    w('{')
+    w('    uint32_t n = 0;')
+    w('    while (n < max && s[n] != 0) n++;')
+    w('    return n;')
+    w('}')
+    w('')
+    w('/** Read a string written for a buffer of the given size, with its terminator */')
+    w('static void tfs_string(PayloadParser *pp, char *buf, uint32_t size)')
+    w('{')
+    w('    if (pp_string(pp, buf, size) == size - 1) {')
+    w('        // The string filled the buffer, pp_string() stopped before the terminator')
+    w('        if (pp_u8(pp) != 0) pp->ok = 0;')
+    w('    }')
+    w('}')
+
+    for m in messages:
+        up = m.name.upper()
+        loop = needs_loop_var(m)
+
+        w('')
+        w('// --- %s ---' % m.name)
+        w('')
+        w('bool %s_encode(PayloadBuilder *pb, const %s *m)' % (m.name, m.name))
+        w('{')
+        if loop:
+            w('    uint32_t i;')
+        w('    pb->bigendian = %s;' % bigendian)
+        if not m.fields:
+            w('    (void)m;')
+        for f in m.fields:
+            for line in encode_field(f, e):
+                w('    ' + line)
+        w('    return pb->ok;')
+        w('}')
+        w('')
+        w('bool %s_decode(PayloadParser *pp, %s *m)' % (m.name, m.name))
+        w('{')
+        if loop:
+            w('    uint32_t i;')
+        w('    pp->bigendian = %s;' % bigendian)
+        if m.size is not None and m.fields:
+            w('    if (pp->empty_handler == NULL) {')
+            w('        // Fixed size - check the length once and read without bounds checks')
+            w('        if (!pp_require(pp, %s_SIZE)) return false;' % up)
+            for f in m.fields:
+                for line in decode_field_raw(f, e):
+                    w('        ' + line)
+            w('        return pp->ok;')
+            w('    }')
+            w('')
+            w('    // Streamed payload, the reads are checked')
+        if not m.fields:
+            w('    (void)m;')
+        for f in m.fields:
+            for line in decode_field(f, e):
+                w('    ' + line)
+        w('    return pp->ok;')
+        w('}')
+        w('')
+        w('bool %s_send(TinyFrame *tf, TF_Msg *msg, const %s *m)' % (m.name, m.name))
+        w('{')
+        w('    TF_Msg local;')
+        w('    PayloadBuilder pb;')
+        w('')
+        w('    if (msg == NULL) {')
+        w('        TF_ClearMsg(&local);')
+        w('        msg = &local;')
+        w('    }')
+        w('    msg->type = %s_TYPE;' % up)
+        w('    msg->len = %s;' % ('%s_SIZE' % up if m.size is not None else '0; // filled in when closing'))
+        w('')
+        w('    if (!TF_Send_Builder(tf, msg, &pb, %s)) return false;' % bigendian)
+        w('    %s_encode(&pb, m);' % m.name)
+        w('    return TF_Builder_Close(tf, &pb);')
+        w('}')
+        w('')
+        w('/** Type Listener decoding %s */' % m.name)
+        w('static TF_Result %s_listener(TinyFrame *tf, TF_Msg *msg)' % m.name)
+        w('{')
+        w('    %s m;' % m.name)
+        w('    PayloadParser pp = pp_start(msg->data, msg->len, NULL);')
+        w('')
+        w('    if (!%s_decode(&pp, &m)) {' % m.name)
+        w('        TF_Error("Malformed %s frame");' % m.name)
+        w('        return TF_STAY;')
+        w('    }')
+        w('    return on_%s(tf, msg, &m);' % m.name)
+        w('}')
+
+    w('')
+    w('bool %s_register(TinyFrame *tf)' % base)
+    w('{')
+    for m in messages:
+        w('    if (!TF_AddTypeListener(tf, %s_TYPE, %s_listener)) return false;' % (m.name.upper(), m.name))
+    if not messages:
+        w('    (void)tf;')
+    w('    return true;')
+    w('}')
+    return '\n'.join(out) + '\n'
+
+
+def gen_stubs(base, messages):
+    out = []
+    w = out.append
+    w('// Handler stubs generated by tf_schema.py from %s.tfs - copy and fill in' % base)
+    w('')
+    w('#include "%s.h"' % base)
+    for m in messages:
+        w('')
+        w('TF_Result on_%s(TinyFrame *tf, TF_Msg *msg, const %s *m)' % (m.name, m.name))
+        w('{')
+        w('    // TODO handle %s' % m.name)
+        w('    return TF_STAY;')
+        w('}')
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Generate C payload code from a TinyFrame schema')
+    ap.add_argument('schema', help='schema file (.tfs)')
+    ap.add_argument('-o', '--outdir', default='.', help='output directory')
+    ap.add_argument('--stubs', action='store_true', help='also generate <name>_stubs.c with empty handlers')
+    args = ap.parse_args()
+
+    base = os.path.splitext(os.path.basename(args.schema))[0]
+    if not re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', base):
+        sys.exit('%s: schema file name must be a valid C identifier' % args.schema)
+
+    with open(args.schema) as f:
+        text = f.read()
+
+    try:
+        endian, messages = Parser(text).parse()
+        check(messages)
+    except SchemaError as ex:
+        sys.exit('%s: %s' % (args.schema, ex))
+
+    files = {
+        base + '.h': gen_header(base, endian, messages),
+        base + '.c': gen_source(base, endian, messages),
+    }
+    if args.stubs:
+        files[base + '_stubs.c'] = gen_stubs(base, messages)
+
+    os.makedirs(args.outdir, exist_ok=True)
+    for name, content in files.items():
+        with open(os.path.join(args.outdir, name), 'w') as f:
+            f.write(content)
+
+
+if __name__ == '__main__':
+    main()
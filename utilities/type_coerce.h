@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 union conv8 {
     uint8_t u8;
@@ -29,4 +30,177 @@ union conv32 {
     float f32;
 };
 
+union conv64 {
+    uint64_t u64;
+    int64_t i64;
+    double f64;
+};
+
+/** Zigzag-encode a signed number (small magnitudes become small unsigned numbers) */
+static inline uint64_t tc_zigzag_enc(int64_t x)
+{
+    return ((uint64_t) x << 1) ^ (uint64_t) (x >> 63);
+}
+
+/** Decode a zigzag-encoded number */
+static inline int64_t tc_zigzag_dec(uint64_t x)
+{
+    return (int64_t) (x >> 1) ^ -(int64_t) (x & 1);
+}
+
+// Host byte order, if the compiler tells us. Arrays are copied in bulk
+// (and byte-swapped if needed) only when it's known.
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    #define TC_HOST_ENDIAN_KNOWN 1
+    #define TC_HOST_BIGENDIAN 0
+#elif defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    #define TC_HOST_ENDIAN_KNOWN 1
+    #define TC_HOST_BIGENDIAN 1
+#else
+    #define TC_HOST_ENDIAN_KNOWN 0
+#endif
+
+#if defined(__GNUC__)
+    #define TC_BSWAP16(x) __builtin_bswap16(x)
+    #define TC_BSWAP32(x) __builtin_bswap32(x)
+#else
+    #define TC_BSWAP16(x) ((uint16_t) (((x) >> 8) | ((x) << 8)))
+    #define TC_BSWAP32(x) ((((x) >> 24) & 0xFF) | (((x) >> 8) & 0xFF00) | \
+                          (((x) & 0xFF00) << 8) | (((x) & 0xFF) << 24))
+#endif
+
+/**
+ * Reverse the byte order of 16-bit words in a buffer (need not be aligned).
+ * The loop is simple enough for the compiler to vectorize it.
+ */
+static inline void tc_bswap16_array(void *buf, uint32_t count)
+{
+    uint8_t *p = (uint8_t *) buf;
+    uint16_t x;
+    uint32_t i;
+    for (i = 0; i < count; i++, p += 2) {
+        memcpy(&x, p, 2);
+        x = TC_BSWAP16(x);
+        memcpy(p, &x, 2);
+    }
+}
+
+/**
+ * Reverse the byte order of 32-bit words in a buffer (need not be aligned).
+ */
+static inline void tc_bswap32_array(void *buf, uint32_t count)
+{
+    uint8_t *p = (uint8_t *) buf;
+    uint32_t x;
+    uint32_t i;
+    for (i = 0; i < count; i++, p += 4) {
+        memcpy(&x, p, 4);
+        x = TC_BSWAP32(x);
+        memcpy(p, &x, 4);
+    }
+}
+
+// --- unaligned loads and stores with a fixed byte order ---
+// With a known host byte order, these compile to a single load/store (+ bswap).
+
+/** Load little-endian uint16_t */
+static inline uint16_t tc_load_le16(const uint8_t *p)
+{
+#if TC_HOST_ENDIAN_KNOWN
+    uint16_t x;
+    memcpy(&x, p, 2);
+    return TC_HOST_BIGENDIAN ? TC_BSWAP16(x) : x;
+#else
+    return (uint16_t) (p[0] | (p[1] << 8));
+#endif
+}
+
+/** Load big-endian uint16_t */
+static inline uint16_t tc_load_be16(const uint8_t *p)
+{
+#if TC_HOST_ENDIAN_KNOWN
+    uint16_t x;
+    memcpy(&x, p, 2);
+    return TC_HOST_BIGENDIAN ? x : TC_BSWAP16(x);
+#else
+    return (uint16_t) ((p[0] << 8) | p[1]);
+#endif
+}
+
+/** Load little-endian uint32_t */
+static inline uint32_t tc_load_le32(const uint8_t *p)
+{
+#if TC_HOST_ENDIAN_KNOWN
+    uint32_t x;
+    memcpy(&x, p, 4);
+    return TC_HOST_BIGENDIAN ? TC_BSWAP32(x) : x;
+#else
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+#endif
+}
+
+/** Load big-endian uint32_t */
+static inline uint32_t tc_load_be32(const uint8_t *p)
+{
+#if TC_HOST_ENDIAN_KNOWN
+    uint32_t x;
+    memcpy(&x, p, 4);
+    return TC_HOST_BIGENDIAN ? x : TC_BSWAP32(x);
+#else
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+#endif
+}
+
+/** Store little-endian uint16_t */
+static inline void tc_store_le16(uint8_t *p, uint16_t x)
+{
+#if TC_HOST_ENDIAN_KNOWN
+    if (TC_HOST_BIGENDIAN) x = TC_BSWAP16(x);
+    memcpy(p, &x, 2);
+#else
+    p[0] = (uint8_t) (x & 0xFF);
+    p[1] = (uint8_t) ((x >> 8) & 0xFF);
+#endif
+}
+
+/** Store big-endian uint16_t */
+static inline void tc_store_be16(uint8_t *p, uint16_t x)
+{
+#if TC_HOST_ENDIAN_KNOWN
+    if (!TC_HOST_BIGENDIAN) x = TC_BSWAP16(x);
+    memcpy(p, &x, 2);
+#else
+    p[0] = (uint8_t) ((x >> 8) & 0xFF);
+    p[1] = (uint8_t) (x & 0xFF);
+#endif
+}
+
+/** Store little-endian uint32_t */
+static inline void tc_store_le32(uint8_t *p, uint32_t x)
+{
+#if TC_HOST_ENDIAN_KNOWN
+    if (TC_HOST_BIGENDIAN) x = TC_BSWAP32(x);
+    memcpy(p, &x, 4);
+#else
+    p[0] = (uint8_t) (x & 0xFF);
+    p[1] = (uint8_t) ((x >> 8) & 0xFF);
+    p[2] = (uint8_t) ((x >> 16) & 0xFF);
+    p[3] = (uint8_t) ((x >> 24) & 0xFF);
+#endif
+}
+
+/** Store big-endian uint32_t */
+static inline void tc_store_be32(uint8_t *p, uint32_t x)
+{
+#if TC_HOST_ENDIAN_KNOWN
+    if (!TC_HOST_BIGENDIAN) x = TC_BSWAP32(x);
+    memcpy(p, &x, 4);
+#else
+    p[0] = (uint8_t) ((x >> 24) & 0xFF);
+    p[1] = (uint8_t) ((x >> 16) & 0xFF);
+    p[2] = (uint8_t) ((x >> 8) & 0xFF);
+    p[3] = (uint8_t) (x & 0xFF);
+#endif
+}
+
 #endif // TYPE_COERCE_H